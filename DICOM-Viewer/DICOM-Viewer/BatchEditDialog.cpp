@@ -0,0 +1,104 @@
+#include "BatchEditDialog.h"
+#include <QtWidgets/qfiledialog.h>
+#include <QtWidgets/qmessagebox.h>
+
+BatchEditDialog::BatchEditDialog(QWidget * parent) : QDialog(parent)
+{
+	ui.setupUi(this);
+	setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+	this->setAttribute(Qt::WA_DeleteOnClose, true);
+	connect(&editor, &DcmBatchEditor::progress, this, &BatchEditDialog::editorProgress);
+	connect(&editor, &DcmBatchEditor::finished, this, &BatchEditDialog::editorFinished);
+}
+
+//========================================================================================================================
+void BatchEditDialog::alertFailed(const QString& message)
+{
+	auto* messageBox = new QMessageBox();
+	messageBox->setIcon(QMessageBox::Warning);
+	messageBox->setText(message);
+	messageBox->exec();
+	delete messageBox;
+}
+
+//========================================================================================================================
+void BatchEditDialog::browseInput()
+{
+	const QString folder = QFileDialog::getExistingDirectory(this, tr("Input Folder"));
+
+	if (!folder.isEmpty())
+	{
+		ui.lineInput->setText(folder);
+	}
+}
+
+//========================================================================================================================
+void BatchEditDialog::browseOutput()
+{
+	const QString folder = QFileDialog::getExistingDirectory(this, tr("Output Folder"));
+
+	if (!folder.isEmpty())
+	{
+		ui.lineOutput->setText(folder);
+	}
+}
+
+//========================================================================================================================
+void BatchEditDialog::startPressed()
+{
+	const QString input = QDir(ui.lineInput->text()).absolutePath();
+	const QString output = QDir(ui.lineOutput->text()).absolutePath();
+
+	if (ui.lineInput->text().isEmpty() || ui.lineOutput->text().isEmpty() || input == output)
+	{
+		alertFailed("Select different input and output folders!");
+		return;
+	}
+
+	std::vector<DcmBatchEditor::Rule> rules;
+	QString error;
+
+	if (!DcmBatchEditor::parseRules(ui.textRules->toPlainText(), rules, error))
+	{
+		alertFailed(error);
+		return;
+	}
+
+	ui.buttonStart->setEnabled(false);
+	ui.progressBar->setValue(0);
+	ui.labelStatus->setText("Running...");
+	this->editor.start(input, output, rules, ui.spinThreads->value());
+}
+
+//========================================================================================================================
+void BatchEditDialog::cancelPressed()
+{
+	if (this->editor.isRunning())
+	{
+		this->editor.cancel();
+		return;
+	}
+
+	this->close();
+}
+
+//========================================================================================================================
+void BatchEditDialog::editorProgress(const int done, const int total)
+{
+	ui.progressBar->setMaximum(total);
+	ui.progressBar->setValue(done);
+	ui.labelStatus->setText(QString::number(done) + " / " + QString::number(total));
+}
+
+//========================================================================================================================
+void BatchEditDialog::editorFinished()
+{
+	ui.buttonStart->setEnabled(true);
+	ui.labelStatus->setText("Done, " + QString::number(this->editor.failedCount()) + " failed");
+	const QStringList failures = this->editor.getFailures();
+
+	if (!failures.isEmpty())
+	{
+		alertFailed(QStringList(failures.mid(0, 20)).join('\n') + (failures.size() > 20 ? "\n... and " + QString::number(failures.size() - 20) + " more" : QString()));
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QObject>
+#include <qdialog.h>
+#include "ui_BatchEditDialog.h"
+#include "DcmBatchEditor.h"
+
+class BatchEditDialog final : public QDialog
+{
+	Q_OBJECT
+
+	public:
+		explicit BatchEditDialog(QWidget* parent);
+		~BatchEditDialog() = default;
+
+	private:
+		Ui::batchEditDialog ui{};
+		DcmBatchEditor editor;
+		static void alertFailed(const QString& message);
+
+	private slots:
+		void browseInput();
+		void browseOutput();
+		void startPressed();
+		void cancelPressed();
+		void editorProgress(int done, int total);
+		void editorFinished();
+};
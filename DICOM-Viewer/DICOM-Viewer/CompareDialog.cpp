@@ -1,19 +1,59 @@
 #include "CompareDialog.h"
+#include "DcmCompareReport.h"
+#include "DcmPrivateDictionary.h"
+#include "DcmProfiler.h"
+#include "DcmStringPool.h"
+#include "ImageDiffDialog.h"
+#include <QRunnable>
+#include <algorithm>
+#include <functional>
+#include <iterator>
 
 #define SPACE "  "
+#define SCRIPT_CHUNK 4096
+
+class DcmCompareTask final : public QRunnable
+{
+	public:
+		explicit DcmCompareTask(std::function<void()> work) : work(std::move(work)) { }
+
+		void run() override
+		{
+			this->work();
+		}
+
+	private:
+		std::function<void()> work;
+};
 
 CompareDialog::CompareDialog(QWidget * parent)
 {
 	ui.setupUi(this);
-	ui.tableWidget1->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
-	ui.tableWidget1->verticalHeader()->setDefaultSectionSize(14);
-	ui.tableWidget1->setSelectionBehavior(QAbstractItemView::SelectRows);
-	ui.tableWidget1->setEditTriggers(QAbstractItemView::NoEditTriggers);
-	ui.tableWidget1->setColumnWidth(2, ui.tableWidget1->columnWidth(2) * 3);
+	this->model = new DcmCompareModel(this);
+	this->filter = new DcmCompareFilter(this);
+	this->filter->setSourceModel(this->model);
+	ui.tableCompare->setModel(this->filter);
+	ui.tableCompare->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+	ui.tableCompare->verticalHeader()->setDefaultSectionSize(14);
+	ui.tableCompare->setSelectionBehavior(QAbstractItemView::SelectRows);
+	ui.tableCompare->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	ui.tableCompare->setColumnWidth(2, ui.tableCompare->columnWidth(2) * 3);
 	this->setAttribute(Qt::WA_DeleteOnClose, true);
-	QHeaderView *verticalHeader = ui.tableWidget1->verticalHeader();
+	QHeaderView *verticalHeader = ui.tableCompare->verticalHeader();
 	verticalHeader->setSectionResizeMode(QHeaderView::Fixed);
 	verticalHeader->setDefaultSectionSize(10);
+	ui.progressBar->setVisible(false);
+	ui.buttonCancel->setVisible(false);
+	connect(this, &CompareDialog::loadFinished, this, &CompareDialog::loadCompleted, Qt::QueuedConnection);
+	connect(this, &CompareDialog::rowsAvailable, this, &CompareDialog::rowsReady, Qt::QueuedConnection);
+	connect(this, &CompareDialog::mergeFinished, this, &CompareDialog::mergeCompleted, Qt::QueuedConnection);
+}
+
+//========================================================================================================================
+CompareDialog::~CompareDialog()
+{
+	this->cancelled = true;
+	this->pool.waitForDone();
 }
 
 //========================================================================================================================
@@ -32,142 +72,199 @@ void CompareDialog::replace(std::string & str, const std::string & from, const s
 }
 
 //========================================================================================================================
-void CompareDialog::loadFile(DcmFileFormat* file, const QString& fileName, bool first)
+bool CompareDialog::loadFile(DcmFileFormat* file, const QString& fileName, const bool first)
 {
-	if (file->loadFile(fileName.toStdString().c_str()).good())
+	DcmProfiler::Scope scope("Compare load file");
+
+	if (file->loadFile(fileName.toStdString().c_str()).bad())
 	{
-		ui.tableWidget1->scrollToTop();
-		extractData(file);
+		return false;
 	}
-	
-	else
+
+	Extraction extraction{ file, first ? &this->elements1 : &this->elements2 };
+	this->extractData(extraction);
+	return !this->cancelled;
+}
+
+//========================================================================================================================
+void CompareDialog::startLoad(const bool first, const QString& fileName)
+{
+	this->clearTable();
+	this->cancelled = false;
+	(first ? this->elements1 : this->elements2).clear();
+	(first ? this->loading1 : this->loading2) = true;
+	this->updateBusy();
+
+	// both files can be parsed at the same time, each side only touches its own file and element list
+	this->pool.start(new DcmCompareTask([this, first, fileName]()
 	{
-		alertFailed("Failed to open file!");
-	}
+		const bool ok = this->loadFile(first ? &this->file1 : &this->file2, fileName, first);
+		emit loadFinished(first, ok);
+	}));
+}
+
+//========================================================================================================================
+void CompareDialog::startMerge()
+{
+	this->clearTable();
+	this->merging = true;
+	this->streaming = true;
+	ui.tableCompare->scrollToTop();
+
+	this->pool.start(new DcmCompareTask([this]()
+	{
+		this->merge();
+		emit mergeFinished();
+	}));
 }
 
 //========================================================================================================================
-void CompareDialog::extractData(DcmFileFormat* file)
+void CompareDialog::flushScript(const bool force)
 {
-	DcmMetaInfo* metaInfo = file->getMetaInfo();
-	DcmDataset* dataSet = file->getDataset();
+	if (!force && this->script.size() < SCRIPT_CHUNK)
+	{
+		return;
+	}
 
-	for (unsigned long i = 0; i < metaInfo->card(); i++)
+	if (this->report)
 	{
-		insertInTable(metaInfo->getElement(i),file);
+		for (const auto& row : this->script)
+		{
+			this->report->write(row);
+		}
 	}
 
-	for (unsigned long i = 0; i < dataSet->card(); i++)
+	if (this->keepRows && !this->streaming)
 	{
-		insertInTable(dataSet->getElement(i),file);
+		this->model->appendRows(std::move(this->script));
 	}
 
-	if (loaded >= 2)
+	else if (this->keepRows && !this->cancelled)
 	{
-		merge();
-		populateTableElementsVector();
+		{
+			std::lock_guard<std::mutex> lock(this->pendingMutex);
+			this->pending.insert(this->pending.end(), std::make_move_iterator(this->script.begin()), std::make_move_iterator(this->script.end()));
+		}
+
+		emit rowsAvailable(this->globalIndex, static_cast<int>(std::max(this->elements1.size(), this->elements2.size())));
 	}
 
-	globalIndex = 0;
+	this->script.clear();
 }
 
 //========================================================================================================================
-void CompareDialog::insertInTable(DcmElement* element, DcmFileFormat* file)
+void CompareDialog::updateBusy() const
 {
-	this->depthRE = 0;
-	this->getNestedSequences(element->getTag().getBaseTag(),nullptr,file);
+	const bool busy = this->loading1 || this->loading2 || this->merging;
 
-	if (!this->nestedElements.empty())
-	{
-		for (auto widget_element : this->nestedElements)
-		{
-			indent(widget_element, widget_element.getDepth());
-			DcmWidgetElement copyElement = DcmWidgetElement(widget_element);
-			copyElement.setTableIndex(globalIndex);
-			copyElement.calculateDepthFromTag();
+	ui.buttonLoad1->setEnabled(!this->loading1 && !this->merging);
+	ui.butonLoad2->setEnabled(!this->loading2 && !this->merging);
+	ui.buttonImages->setEnabled(!busy);
+	ui.buttonExport->setEnabled(!busy);
+	ui.buttonApply->setEnabled(!busy);
+	ui.buttonCancel->setVisible(busy);
+	ui.progressBar->setVisible(busy);
 
-			if (firstFile == true)
-			{
-				this->elements1.push_back(copyElement);
-			}
+	if (busy && !this->merging)
+	{
+		ui.progressBar->setRange(0, 0);
+	}
+}
 
-			else
-			{
-				this->elements2.push_back(copyElement);
-			}
+//========================================================================================================================
+void CompareDialog::extractData(Extraction& extraction)
+{
+	DcmProfiler::Scope scope("Compare extract data");
 
-			this->globalIndex++;
-		}
+	DcmMetaInfo* metaInfo = extraction.file->getMetaInfo();
+	DcmDataset* dataSet = extraction.file->getDataset();
 
-		this->nestedElements.clear();
+	for (unsigned long i = 0; i < metaInfo->card() && !this->cancelled; i++)
+	{
+		insertInTable(metaInfo->getElement(i), extraction);
 	}
 
-	else
+	for (unsigned long i = 0; i < dataSet->card() && !this->cancelled; i++)
 	{
-		DcmWidgetElement widgetElement = createElement(element, nullptr, nullptr);
-		widgetElement.setItemTag(widgetElement.getItemTag().toUpper());
-		DcmWidgetElement copyElement = DcmWidgetElement(widgetElement);
-		copyElement.setTableIndex(globalIndex);
-		copyElement.calculateDepthFromTag();
+		insertInTable(dataSet->getElement(i), extraction);
+	}
+}
 
-		if (firstFile == true)
-		{
-			this->elements1.push_back(copyElement);
-		}
+//========================================================================================================================
+void CompareDialog::insertInTable(DcmElement* element, Extraction& extraction)
+{
+	extraction.depth = 0;
+	this->getNestedSequences(element->getTag().getBaseTag(), nullptr, extraction);
 
-		else
+	if (!extraction.nestedElements.empty())
+	{
+		for (auto& widget_element : extraction.nestedElements)
 		{
-			this->elements2.push_back(copyElement);
+			indent(widget_element, widget_element.getDepth());
+			widget_element.setTableIndex(extraction.index);
+			widget_element.calculateDepthFromTag();
+			extraction.elements->push_back(std::move(widget_element));
+			extraction.index++;
 		}
 
-		this->globalIndex++;
+		extraction.nestedElements.clear();
+	}
+
+	else
+	{
+		DcmWidgetElement widgetElement = createElement(element, nullptr, nullptr);
+		widgetElement.setItemTag(widgetElement.getItemTag().toUpper());
+		widgetElement.setTableIndex(extraction.index);
+		widgetElement.calculateDepthFromTag();
+		extraction.elements->push_back(std::move(widgetElement));
+		extraction.index++;
 	}
 }
 
 //========================================================================================================================
-void CompareDialog::getNestedSequences(const DcmTagKey& tag, DcmSequenceOfItems* sequence, DcmFileFormat* file)
+void CompareDialog::getNestedSequences(const DcmTagKey& tag, DcmSequenceOfItems* sequence, Extraction& extraction)
 {
 	OFCondition cond = OFCondition(EC_CorruptedData);
 
 	if (tag.hasValidGroup())
-		cond = file->getDataset()->findAndGetSequence(tag, sequence, true);
+		cond = extraction.file->getDataset()->findAndGetSequence(tag, sequence, true);
 
 	if (cond.good() || (sequence != nullptr &&  sequence->card()))
 	{
 		DcmWidgetElement widgetElement1 = createElement(nullptr, sequence, nullptr);
-		widgetElement1.setDepth(this->depthRE);
+		widgetElement1.setDepth(extraction.depth);
 		widgetElement1.setItemTag(widgetElement1.getItemTag().toUpper());
-		this->nestedElements.push_back(widgetElement1);
-		this->depthRE++;
+		extraction.nestedElements.push_back(widgetElement1);
+		extraction.depth++;
 
 		for (unsigned long i = 0; i < sequence->card(); i++)
 		{
 			DcmWidgetElement widgetElement2 = createElement(nullptr, nullptr, sequence->getItem(i));
-			widgetElement2.setDepth(this->depthRE);
+			widgetElement2.setDepth(extraction.depth);
 			widgetElement2.setItemTag(widgetElement2.getItemTag().toUpper());
-			this->nestedElements.push_back(widgetElement2);
-			this->iterateItem(sequence->getItem(i), this->depthRE, file);
+			extraction.nestedElements.push_back(widgetElement2);
+			this->iterateItem(sequence->getItem(i), extraction.depth, extraction);
 			DcmWidgetElement widgetElementDelim = DcmWidgetElement(
-				QString("(FFFE,E00D)"),
+				QStringLiteral("(FFFE,E00D)"),
 				QString(""), QString("0"),
 				QString("0"),
-				QString("ItemDelimitationItem"),
+				QStringLiteral("ItemDelimitationItem"),
 				QString(""));
-			this->depthRE--;
-			widgetElementDelim.setDepth(this->depthRE);
-			this->nestedElements.push_back(widgetElementDelim);
+			extraction.depth--;
+			widgetElementDelim.setDepth(extraction.depth);
+			extraction.nestedElements.push_back(widgetElementDelim);
 		}
 
 		DcmWidgetElement widgetElementDelim = DcmWidgetElement(
-			QString("(FFFE,E0DD)"),
+			QStringLiteral("(FFFE,E0DD)"),
 			QString(""),
 			QString("0"),
 			QString("0"),
-			QString("SequenceDelimitationItem"),
+			QStringLiteral("SequenceDelimitationItem"),
 			QString(""));
-		this->depthRE--;
-		widgetElementDelim.setDepth(this->depthRE);
-		this->nestedElements.push_back(widgetElementDelim);
+		extraction.depth--;
+		widgetElementDelim.setDepth(extraction.depth);
+		extraction.nestedElements.push_back(widgetElementDelim);
 	}
 }
 
@@ -188,7 +285,7 @@ void CompareDialog::indent(DcmWidgetElement & element, int depth)
 }
 
 //========================================================================================================================
-void CompareDialog::iterateItem(DcmItem * item, int & depth, DcmFileFormat* file)
+void CompareDialog::iterateItem(DcmItem * item, int & depth, Extraction& extraction)
 {
 	depth++;
 
@@ -200,42 +297,16 @@ void CompareDialog::iterateItem(DcmItem * item, int & depth, DcmFileFormat* file
 		if (widgetElement.getItemVR() != "SQ")
 		{
 			widgetElement.setDepth(depth);
-			this->nestedElements.push_back(widgetElement);
+			extraction.nestedElements.push_back(widgetElement);
 		}
 
 		DcmTagKey NULLkey;
 		DcmSequenceOfItems* sequence;
 		item->getElement(i)->getParentItem()->findAndGetSequence(item->getElement(i)->getTag().getBaseTag(), sequence, true);
-		this->getNestedSequences(NULLkey, sequence,file);
+		this->getNestedSequences(NULLkey, sequence, extraction);
 	}
 }
 
-//========================================================================================================================
-void CompareDialog::insertRight(DcmWidgetElement element, int & index) const
-{
-	if (index >= ui.tableWidget1->rowCount())
-	{
-		ui.tableWidget1->insertRow(index);
-	}
-
-	ui.tableWidget1->setItem(index, 3, new QTableWidgetItem(element.getItemTag()));
-	ui.tableWidget1->setItem(index, 4, new QTableWidgetItem(element.getItemLength()));
-	ui.tableWidget1->setItem(index, 5, new QTableWidgetItem(element.getItemValue()));
-}
-
-//========================================================================================================================
-void CompareDialog::insert(DcmWidgetElement element, int & index) const
-{
-	if (index >= ui.tableWidget1->rowCount())
-	{
-		ui.tableWidget1->insertRow(index);
-	}
-
-	ui.tableWidget1->setItem(index, 0, new QTableWidgetItem(element.getItemTag()));
-	ui.tableWidget1->setItem(index, 1, new QTableWidgetItem(element.getItemLength()));
-	ui.tableWidget1->setItem(index, 2, new QTableWidgetItem(element.getItemValue()));
-}
-
 //========================================================================================================================
 DcmWidgetElement CompareDialog::createElement(DcmElement * element, DcmSequenceOfItems * sequence, DcmItem * item) const
 {
@@ -244,52 +315,20 @@ DcmWidgetElement CompareDialog::createElement(DcmElement * element, DcmSequenceO
 		DcmTagKey tagKey = DcmTagKey(
 			OFstatic_cast(Uint16, element->getGTag()),
 			OFstatic_cast(Uint16, element->getETag()));
-		DcmTag tagName = DcmTag(tagKey);
-		DcmVR vr = DcmVR(element->getVR());
-		std::string finalString;
-
-		if (tagKey != DCM_PixelData && element->getLengthField() <= 50)
-		{
-			OFString value;
-			element->getOFStringArray(value, true);
-			finalString = value.c_str();
-			replace(finalString, "\\", " ");
-		}
-
-		else
-		{
-			for (int i = 0; i < 10; i++)
-			{
-				OFString value;
-				element->getOFString(value, i, false);
-				finalString.append(value.c_str());
-				finalString.append(" ");
-			}
-		}
 
 
-		if (strcmp(vr.getVRName(), "??") == 0)
-		{
-			DcmWidgetElement widgetElement = DcmWidgetElement(
-				QString::fromStdString(tagKey.toString().c_str()),
-				QString::fromStdString(""),
-				QString::fromStdString(std::to_string(element->getVM())),
-				QString::fromStdString(std::to_string(element->getLength())),
-				"",
-				QString::fromStdString(finalString));
-
-			return widgetElement;
-		}
-
+		const DcmStringPool::Descriptor& descriptor = DcmStringPool::descriptor(tagKey, element->getVR());
+		DcmPrivateDictionary::Entry privateEntry;
+		const bool isPrivate = DcmPrivateDictionary::find(element, privateEntry);
 		DcmWidgetElement widgetElement = DcmWidgetElement(
-			QString::fromStdString(tagKey.toString().c_str()),
-			QString::fromStdString(vr.getVRName()),
-			QString::fromStdString(std::to_string(element->getVM())),
-			QString::fromStdString(std::to_string(element->getLength())),
-			tagName.getTagName(),
-			QString::fromStdString(finalString));
-
-
+			descriptor.tag,
+			isPrivate && (descriptor.vr.isEmpty() || descriptor.vr == "UN") ? privateEntry.vr : descriptor.vr,
+			DcmStringPool::number(element->getVM()),
+			DcmStringPool::number(element->getLength()),
+			isPrivate ? privateEntry.name : descriptor.description,
+			QString());
+
+		widgetElement.setSource(element);
 		return widgetElement;
 	}
 
@@ -298,52 +337,15 @@ DcmWidgetElement CompareDialog::createElement(DcmElement * element, DcmSequenceO
 		DcmTagKey tagKey = DcmTagKey(
 			OFstatic_cast(Uint16, sequence->getGTag()),
 			OFstatic_cast(Uint16, sequence->getETag()));
-		DcmTag tagName = DcmTag(tagKey);
-		DcmVR vr = DcmVR(sequence->getVR());
-		std::string finalString;
-
-		if (tagKey != DCM_PixelData && sequence->getLengthField() <= 50)
-		{
-			OFString value;
-			sequence->getOFStringArray(value, true);
-			finalString = value.c_str();
-			replace(finalString, "\\", " ");
-		}
-
-
-		else
-		{
-			for (int i = 0; i < 10; i++)
-			{
-				OFString value;
-				sequence->getOFString(value, i, false);
-				finalString.append(value.c_str());
-				finalString.append(" ");
-			}
-
-		}
-
-		if (strcmp(vr.getVRName(), "??") == 0)
-		{
-			DcmWidgetElement widgetElement = DcmWidgetElement(
-				QString::fromStdString(tagKey.toString().c_str()),
-				QString::fromStdString(""),
-				QString::fromStdString(std::to_string(sequence->getVM())),
-				QString::fromStdString(std::to_string(sequence->getLength())),
-				"",
-				QString::fromStdString(finalString));
-
-			return widgetElement;
-		}
 
+		const DcmStringPool::Descriptor& descriptor = DcmStringPool::descriptor(tagKey, sequence->getVR());
 		DcmWidgetElement widgetElement = DcmWidgetElement(
-			QString::fromStdString(tagKey.toString().c_str()),
-			QString::fromStdString(vr.getVRName()),
-			QString::fromStdString(std::to_string(sequence->getVM())),
-			QString::fromStdString(std::to_string(sequence->getLength())),
-			tagName.getTagName(),
-			QString::fromStdString(finalString));
-
+			descriptor.tag,
+			descriptor.vr,
+			DcmStringPool::number(sequence->getVM()),
+			DcmStringPool::number(sequence->getLength()),
+			descriptor.description,
+			QString());
 
 		return widgetElement;
 	}
@@ -353,31 +355,16 @@ DcmWidgetElement CompareDialog::createElement(DcmElement * element, DcmSequenceO
 		DcmTagKey tagKey = DcmTagKey(
 			OFstatic_cast(Uint16, item->getGTag()),
 			OFstatic_cast(Uint16, item->getETag()));
-		DcmTag tagName = DcmTag(tagKey);
-		DcmVR vr = DcmVR(item->getVR());
 
 
-		if (strcmp(vr.getVRName(), "??") == 0)
-		{
-			DcmWidgetElement widgetElement = DcmWidgetElement(
-				QString::fromStdString(tagKey.toString().c_str()),
-				QString::fromStdString(""),
-				QString::fromStdString(std::to_string(item->getVM())),
-				QString::fromStdString(std::to_string(item->getLength())),
-				"",
-				QString::fromStdString(""));
-
-			return widgetElement;
-		}
-
+		const DcmStringPool::Descriptor& descriptor = DcmStringPool::descriptor(tagKey, item->getVR());
 		DcmWidgetElement widgetElement = DcmWidgetElement(
-			QString::fromStdString(tagKey.toString().c_str()),
-			QString::fromStdString(vr.getVRName()),
-			QString::fromStdString(std::to_string(item->getVM())),
-			QString::fromStdString(std::to_string(item->getLength())),
-			tagName.getTagName(),
-			QString::fromStdString(""));
-
+			descriptor.tag,
+			descriptor.vr,
+			DcmStringPool::number(item->getVM()),
+			DcmStringPool::number(item->getLength()),
+			descriptor.description,
+			QString());
 
 		return widgetElement;
 	}
@@ -387,57 +374,50 @@ DcmWidgetElement CompareDialog::createElement(DcmElement * element, DcmSequenceO
 }
 
 //========================================================================================================================
-void CompareDialog::insertBoth(DcmWidgetElement el1, DcmWidgetElement el2, int &index, const int status) const
+void CompareDialog::insertBoth(const DcmWidgetElement& el1, const DcmWidgetElement& el2, const int status)
 {
+	const DcmWidgetElement& element = status == 2 ? el2 : el1;
+	DcmCompareModel::Kind kind = DcmCompareModel::Equal;
+	bool ignored = false;
 
-	ui.tableWidget1->insertRow(index);
+	// values are formatted here, so the view never reads the datasets while a merge is still running
+	el1.getItemValue();
+	el2.getItemValue();
 
-	if (status == 1)
+	// everything inside an ignored sequence is ignored with it
+	if (this->ignoredDepth >= 0 && (element.getDepth() > this->ignoredDepth || (element.getDepth() == this->ignoredDepth && element.getItemDescription() == "SequenceDelimitationItem")))
 	{
-		ui.tableWidget1->setItem(index, 0, new QTableWidgetItem(el1.getItemTag()));
-		ui.tableWidget1->setItem(index, 1, new QTableWidgetItem(el1.getItemLength()));
-		ui.tableWidget1->setItem(index, 2, new QTableWidgetItem(el1.getItemValue()));
-		ui.tableWidget1->setItem(index, 3, new QTableWidgetItem(el2.getItemLength()));
-		ui.tableWidget1->setItem(index, 4, new QTableWidgetItem(el2.getItemValue()));
+		ignored = true;
+	}
 
-		if (!(el1 == el2))
-		{
-			ui.tableWidget1->item(index, 0)->setBackgroundColor(QColor(220, 220, 220));
-			ui.tableWidget1->item(index, 1)->setBackgroundColor(QColor(250, 128, 114));
-			ui.tableWidget1->item(index, 2)->setBackgroundColor(QColor(250, 128, 114));
-			ui.tableWidget1->item(index, 3)->setBackgroundColor(QColor(250, 128, 114));
-			ui.tableWidget1->item(index, 4)->setBackgroundColor(QColor(250, 128, 114));
-		}
+	else
+	{
+		ignored = this->policy.ignores(element);
+		this->ignoredDepth = ignored && element.getItemVR() == "SQ" ? element.getDepth() : -1;
+	}
 
-		else
-		{
-			ui.tableWidget1->item(index, 0)->setBackgroundColor(QColor(220, 220, 220));
-		}
+	if (ignored)
+	{
+		kind = DcmCompareModel::Equal;
+	}
+
+	else if (status == 1)
+	{
+		kind = this->policy.equal(el1, el2) ? DcmCompareModel::Equal : DcmCompareModel::Changed;
 	}
 
 	else if (status == 2)
 	{
-		ui.tableWidget1->setItem(index, 0, new QTableWidgetItem(el1.getItemTag()));
-		ui.tableWidget1->setItem(index, 1, new QTableWidgetItem(el1.getItemLength()));
-		ui.tableWidget1->setItem(index, 2, new QTableWidgetItem(el1.getItemValue()));
-		ui.tableWidget1->setItem(index, 3, new QTableWidgetItem(el2.getItemLength()));
-		ui.tableWidget1->setItem(index, 4, new QTableWidgetItem(el2.getItemValue()));
-		ui.tableWidget1->item(index, 0)->setBackgroundColor(QColor(220, 220, 220));
-		ui.tableWidget1->item(index, 3)->setBackgroundColor(QColor(104, 223, 240));
-		ui.tableWidget1->item(index, 4)->setBackgroundColor(QColor(104, 223, 240));
+		kind = DcmCompareModel::Added;
 	}
 
 	else
 	{
-		ui.tableWidget1->setItem(index, 0, new QTableWidgetItem(el1.getItemTag()));
-		ui.tableWidget1->setItem(index, 1, new QTableWidgetItem(el1.getItemLength()));
-		ui.tableWidget1->setItem(index, 2, new QTableWidgetItem(el1.getItemValue()));
-		ui.tableWidget1->setItem(index, 3, new QTableWidgetItem(el2.getItemLength()));
-		ui.tableWidget1->setItem(index, 4, new QTableWidgetItem(el2.getItemValue()));
-		ui.tableWidget1->item(index, 0)->setBackgroundColor(QColor(220, 220, 220));
-		ui.tableWidget1->item(index, 1)->setBackgroundColor(QColor(0, 250, 154));
-		ui.tableWidget1->item(index, 2)->setBackgroundColor(QColor(0, 250, 154));
+		kind = DcmCompareModel::Removed;
 	}
+
+	this->script.push_back(DcmCompareModel::Row{ el1, el2, kind });
+	this->flushScript(false);
 }
 
 //========================================================================================================================
@@ -445,16 +425,16 @@ void CompareDialog::insertSequence(const int status, int& index1, int& index2)
 {
 	if (status == 1)
 	{
-		insertBoth(this->elements1[index1], this->elements2[index2] , globalIndex, status);
+		insertBoth(this->elements1[index1], this->elements2[index2] , status);
 		index1++;
 		index2++;
 		globalIndex++;
 
-		while (this->elements1[index1].getItemDescription() == "Item" && this->elements2[index2].getItemDescription() == "Item")
+		while (this->elements1[index1].getItemDescription() == "Item" && this->elements2[index2].getItemDescription() == "Item" && !this->cancelled)
 		{
 			const int item1Depth = this->elements1[index1].getDepth();
 			const int item2Depth = this->elements2[index2].getDepth();
-			insertBoth(this->elements1[index1], this->elements2[index2], globalIndex, status);
+			insertBoth(this->elements1[index1], this->elements2[index2], status);
 			index1++;
 			index2++;
 			globalIndex++;
@@ -476,7 +456,7 @@ void CompareDialog::insertSequence(const int status, int& index1, int& index2)
 					insertSequence(3, index1, index2);
 				}
 
-				insertBoth(this->elements1[index1], this->elements2[index2], globalIndex, status);
+				insertBoth(this->elements1[index1], this->elements2[index2], status);
 				index1++;
 				index2++;
 				globalIndex++;
@@ -489,7 +469,7 @@ void CompareDialog::insertSequence(const int status, int& index1, int& index2)
 					insertSequence(status, index1, index2);
 				}
 
-				insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), globalIndex, status);
+				insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), status);
 				index1++;
 				globalIndex++;
 			}
@@ -501,18 +481,18 @@ void CompareDialog::insertSequence(const int status, int& index1, int& index2)
 					insertSequence(status, index1, index2);
 				}
 
-				insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], globalIndex, status);
+				insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], status);
 				index2++;
 				globalIndex++;
 			}
-				insertBoth(this->elements1[index1], this->elements2[index2], globalIndex, status);
+				insertBoth(this->elements1[index1], this->elements2[index2], status);
 				index1++;
 				index2++;
 				globalIndex++;
 		}
 
 
-			insertBoth(this->elements1[index1], this->elements2[index2], globalIndex, status);
+			insertBoth(this->elements1[index1], this->elements2[index2], status);
 			index1++;
 			index2++;
 			globalIndex++;
@@ -520,14 +500,14 @@ void CompareDialog::insertSequence(const int status, int& index1, int& index2)
 
 	else if (status == 2)
 	{
-		insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), globalIndex, 3);
+		insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), 3);
 		index1++;
 		globalIndex++;
 
-		while (this->elements1[index1].getItemDescription() == "Item")
+		while (this->elements1[index1].getItemDescription() == "Item" && !this->cancelled)
 		{
 			const int itemDepth = this->elements1[index1].getDepth();
-			insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), globalIndex, 3);
+			insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), 3);
 			index1++;
 			globalIndex++;
 
@@ -535,7 +515,7 @@ void CompareDialog::insertSequence(const int status, int& index1, int& index2)
 			{
 				if (this->elements1[index1].getItemVR() == "SQ")
 				{
-					insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), globalIndex, 3);
+					insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), 3);
 					index1++;
 					globalIndex++;
 
@@ -543,13 +523,13 @@ void CompareDialog::insertSequence(const int status, int& index1, int& index2)
 
 				}
 
-				insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), globalIndex, 3);
+				insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), 3);
 				index1++;
 				globalIndex++;
 				
 			}
 
-			insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), globalIndex, 3);
+			insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), 3);
 			index1++;
 			globalIndex++;
 
@@ -558,7 +538,7 @@ void CompareDialog::insertSequence(const int status, int& index1, int& index2)
 
 		if (index1 < static_cast<int>(this->elements1.size()) && isDelimitation(this->elements1[index1]))
 		{
-			insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), globalIndex, 3);
+			insertBoth(this->elements1[index1], DcmWidgetElement(this->elements1[index1].getItemTag(), "", "", "", "", ""), 3);
 			index1++;
 			globalIndex++;
 		}
@@ -566,14 +546,14 @@ void CompareDialog::insertSequence(const int status, int& index1, int& index2)
 
 	else
 	{
-		insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], globalIndex, 2);
+		insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], 2);
 		index2++;
 		globalIndex++;
 
-		while (this->elements2[index2].getItemDescription() == "Item")
+		while (this->elements2[index2].getItemDescription() == "Item" && !this->cancelled)
 		{
 			const int itemDepth = this->elements2[index2].getDepth();
-			insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], globalIndex, 2);
+			insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], 2);
 			index2++;
 			globalIndex++;
 
@@ -582,19 +562,19 @@ void CompareDialog::insertSequence(const int status, int& index1, int& index2)
 				if (this->elements2[index2].getItemVR() == "SQ")
 				{
 
-					insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], globalIndex, 2);
+					insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], 2);
 					index2++;
 					globalIndex++;
 
 					insertSequence(status, index1, index2);
 				}
 
-				insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], globalIndex, 2);
+				insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], 2);
 				index2++;
 				globalIndex++;
 			}
 			
-			insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], globalIndex, 2);
+			insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], 2);
 			index2++;
 			globalIndex++;
 		}
@@ -602,7 +582,7 @@ void CompareDialog::insertSequence(const int status, int& index1, int& index2)
 	
 		if (isDelimitation(this->elements2[index2]))
 		{
-			insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], globalIndex, 2);
+			insertBoth(DcmWidgetElement(this->elements2[index2].getItemTag(), "", "", "", "", ""), this->elements2[index2], 2);
 			index2++;
 			globalIndex++;
 		}
@@ -612,6 +592,12 @@ void CompareDialog::insertSequence(const int status, int& index1, int& index2)
 //========================================================================================================================
 void CompareDialog::merge()
 {
+	DcmProfiler::Scope scope("Compare merge");
+
+	this->script.clear();
+	this->policy.learnUids(this->elements1, this->elements2);
+	this->ignoredDepth = -1;
+
 	if (!this->elements1.empty() && !this->elements2.empty())
 	{
 		globalIndex = 0;
@@ -619,7 +605,7 @@ void CompareDialog::merge()
 		int index2 = 0;
 
 
-		while (index1 < static_cast<int>(elements1.size()) - 1 && index2 < static_cast<int>( elements2.size()) - 1)
+		while (index1 < static_cast<int>(elements1.size()) - 1 && index2 < static_cast<int>( elements2.size()) - 1 && !this->cancelled)
 		{
 
 			if (elements1[index1].getItemVR() == "SQ" && elements2[index2].getItemVR() == "SQ")
@@ -652,7 +638,7 @@ void CompareDialog::merge()
 
 			else if (elements1[index1].compareTagKey(elements2[index2]) == 1 )
 			{
-				insertBoth(elements1[index1], elements2[index2],globalIndex, 1);
+				insertBoth(elements1[index1], elements2[index2], 1);
 				index1++;
 				index2++;
 				globalIndex++;
@@ -668,7 +654,7 @@ void CompareDialog::merge()
 				else
 				{
 					const DcmWidgetElement empty = DcmWidgetElement(elements2[index2].getItemTag(), "", "", "", "", "");
-					insertBoth(empty, elements2[index2], globalIndex, 2);
+					insertBoth(empty, elements2[index2], 2);
 					index2++;
 					globalIndex++;
 				}
@@ -684,14 +670,14 @@ void CompareDialog::merge()
 				else
 				{
 					const DcmWidgetElement empty = DcmWidgetElement(elements1[index1].getItemTag(), "", "", "", "", "");
-					insertBoth(elements1[index1], empty, globalIndex, 3);
+					insertBoth(elements1[index1], empty, 3);
 					index1++;
 					globalIndex++;
 				}
 			}
 		}
 
-		while (index1 < static_cast<int>(elements1.size()) - 1)
+		while (index1 < static_cast<int>(elements1.size()) - 1 && !this->cancelled)
 		{
 			if (elements1[index1].getItemVR() == "SQ")
 			{
@@ -702,13 +688,13 @@ void CompareDialog::merge()
 			else
 			{
 				const DcmWidgetElement empty = DcmWidgetElement(elements1[index1].getItemTag(), "", "", "", "", "");
-				insertBoth(elements1[index1],empty, globalIndex, 3);
+				insertBoth(elements1[index1],empty, 3);
 				index1++;
 				globalIndex++;
 			}
 		}
 
-		while (index2 < static_cast<int>(elements2.size()) -1)
+		while (index2 < static_cast<int>(elements2.size()) -1 && !this->cancelled)
 		{
 			if (elements2[index2].getItemVR() == "SQ")
 			{
@@ -719,25 +705,45 @@ void CompareDialog::merge()
 			else
 			{
 				const DcmWidgetElement empty = DcmWidgetElement(elements2[index2].getItemTag(), "", "", "", "", "");
-				insertBoth(empty, elements2[index2], globalIndex, 2);
+				insertBoth(empty, elements2[index2], 2);
 				index2++;
 				globalIndex++;
 			}
 		}
 
-		insertBoth(elements1[elements1.size() - 1], elements2[elements2.size() - 1],globalIndex, 1);
+		insertBoth(elements1[elements1.size() - 1], elements2[elements2.size() - 1], 1);
 	}
+
+	this->flushScript(true);
 }
 
 //========================================================================================================================
-void CompareDialog::clearTable() const
+void CompareDialog::jumpToDifference(const bool forward) const
 {
-	for (int i = ui.tableWidget1->rowCount(); i >= 0; i--)
+	const QModelIndex current = this->filter->mapToSource(ui.tableCompare->currentIndex());
+	int row = current.isValid() ? current.row() : -1;
+
+	// differences hidden by the text filter are stepped over
+	while ((row = forward ? this->model->nextDifference(row) : this->model->previousDifference(row)) >= 0)
 	{
-		ui.tableWidget1->removeRow(i);
+		const QModelIndex index = this->filter->mapFromSource(this->model->index(row, 0));
+
+		if (index.isValid())
+		{
+			ui.tableCompare->setCurrentIndex(index);
+			ui.tableCompare->scrollTo(index, QAbstractItemView::PositionAtCenter);
+			return;
+		}
 	}
 }
 
+//========================================================================================================================
+void CompareDialog::clearTable() const
+{
+	this->model->clear();
+	ui.labelDifferences->clear();
+}
+
 //========================================================================================================================
 bool CompareDialog::isDelimitation(DcmWidgetElement & el)
 {
@@ -754,15 +760,11 @@ void CompareDialog::loadFile1()
 
 	if (!fileName.isEmpty())
 	{
-		clearTable();
-		firstFile = true;
-		elements1.clear();
-		loaded++;
-		this->loadFile(&file1, fileName, true);
 		std::string nr = std::to_string(getFileSize(fileName.toStdString()));
 		precision(nr, 2);
 		ui.labelSize1->setText("Size File 1: " + QString::fromStdString(nr) + " MB");
 		ui.labelPath1->setText("Path File 1: " + fileName);
+		this->startLoad(true, fileName);
 	}
 }
 
@@ -773,15 +775,11 @@ void CompareDialog::loadFile2()
 
 	if (!fileName.isEmpty())
 	{
-		clearTable();
-		firstFile = false;
-		elements2.clear();
-		loaded++;
-		this->loadFile(&file2, fileName, false);
 		std::string nr = std::to_string(getFileSize(fileName.toStdString()));
 		precision(nr, 2);
 		ui.labelSize2->setText("Size File 2: " + QString::fromStdString(nr) + " MB");
 		ui.labelPath2->setText("Path File 2: " + fileName);
+		this->startLoad(false, fileName);
 	}
 }
 
@@ -795,19 +793,6 @@ void CompareDialog::alertFailed(const std::string& message)
 	delete messageBox;
 }
 
-//========================================================================================================================
-void CompareDialog::populateTableElementsVector()
-{
-	this->tableElements.clear();
-	for (int i = 0; i < ui.tableWidget1->rowCount(); i++)
-	{
-		DcmWidgetElement el1 = DcmWidgetElement(ui.tableWidget1->item(i, 0)->text(), "", "", ui.tableWidget1->item(i, 1)->text(), "", ui.tableWidget1->item(i, 2)->text());
-		DcmWidgetElement el2 = DcmWidgetElement(ui.tableWidget1->item(i, 0)->text(), "", "", ui.tableWidget1->item(i, 3)->text(), "", ui.tableWidget1->item(i, 4)->text());
-		std::tuple<DcmWidgetElement, DcmWidgetElement> tuple = std::tuple<DcmWidgetElement, DcmWidgetElement>(el1, el2);
-		this->tableElements.push_back(tuple);
-	}
-}
-
 //========================================================================================================================
 void CompareDialog::precision(std::string & nr, const int & precision)
 {
@@ -843,56 +828,146 @@ double CompareDialog::getFileSize(const std::string& fileName)
 //========================================================================================================================
 void CompareDialog::findText()
 {
-	const QString text = ui.lineSearch->text();
-	if (!text.isEmpty())
+	DcmProfiler::Scope scope("Compare find text");
+
+	this->filter->setText(ui.lineSearch->text());
+}
+
+//========================================================================================================================
+void CompareDialog::compareImages()
+{
+	if (this->loading1 || this->loading2 || this->merging || this->elements1.empty() || this->elements2.empty())
 	{
-		if (!this->tableElements.empty())
-		{
-			std::vector<std::tuple<DcmWidgetElement, DcmWidgetElement>> result;
-			for (auto tuple : this->tableElements)
-			{
-				if (std::get<0>(tuple).checkIfContains(text) || std::get<1>(tuple).checkIfContains(text))
-				{
-					result.push_back(tuple);
-				}
-			}
+		alertFailed("Load both files first!");
+		return;
+	}
 
-			clearTable();
-			for (unsigned long i = 0; i < result.size(); i++)
-			{
-				ui.tableWidget1->insertRow(i);
-				ui.tableWidget1->setItem(i, 0, new QTableWidgetItem(std::get<0>(result[i]).getItemTag()));
-				ui.tableWidget1->setItem(i, 1, new QTableWidgetItem(std::get<0>(result[i]).getItemLength()));
-				ui.tableWidget1->setItem(i, 2, new QTableWidgetItem(std::get<0>(result[i]).getItemValue()));
-				ui.tableWidget1->setItem(i, 3, new QTableWidgetItem(std::get<1>(result[i]).getItemLength()));
-				ui.tableWidget1->setItem(i, 4, new QTableWidgetItem(std::get<1>(result[i]).getItemValue()));
-
-				if (std::get<0>(result[i]).getItemValue() == "")
-				{
-					ui.tableWidget1->item(i, 0)->setBackgroundColor(QColor(220, 220, 220));
-					ui.tableWidget1->item(i, 3)->setBackgroundColor(QColor(104, 223, 240));
-					ui.tableWidget1->item(i, 4)->setBackgroundColor(QColor(104, 223, 240));
-				}
-				else if (std::get<1>(result[i]).getItemValue() == "")
-				{
-					ui.tableWidget1->item(i, 0)->setBackgroundColor(QColor(220, 220, 220));
-					ui.tableWidget1->item(i, 1)->setBackgroundColor(QColor(0, 250, 154));
-					ui.tableWidget1->item(i, 2)->setBackgroundColor(QColor(0, 250, 154));
-				}
-				else if (!(std::get<0>(result[i]) == std::get<1>(result[i])))
-				{
-					ui.tableWidget1->item(i, 0)->setBackgroundColor(QColor(220, 220, 220));
-					ui.tableWidget1->item(i, 1)->setBackgroundColor(QColor(250, 128, 114));
-					ui.tableWidget1->item(i, 2)->setBackgroundColor(QColor(250, 128, 114));
-					ui.tableWidget1->item(i, 3)->setBackgroundColor(QColor(250, 128, 114));
-					ui.tableWidget1->item(i, 4)->setBackgroundColor(QColor(250, 128, 114));
-				}
-			}
+	auto* imageDialog = new ImageDiffDialog(this, &this->file1, &this->file2);
+	imageDialog->show();
+}
+
+//========================================================================================================================
+void CompareDialog::differencesToggled(const bool checked) const
+{
+	this->filter->setDifferencesOnly(checked);
+}
+
+//========================================================================================================================
+void CompareDialog::previousDifference() const
+{
+	this->jumpToDifference(false);
+}
+
+//========================================================================================================================
+void CompareDialog::nextDifference() const
+{
+	this->jumpToDifference(true);
+}
+
+//========================================================================================================================
+void CompareDialog::cancelPressed()
+{
+	this->cancelled = true;
+}
+
+//========================================================================================================================
+void CompareDialog::loadCompleted(const bool first, const bool ok)
+{
+	(first ? this->loading1 : this->loading2) = false;
+
+	if (!ok)
+	{
+		(first ? this->elements1 : this->elements2).clear();
+
+		if (!this->cancelled)
+		{
+			alertFailed("Failed to open file!");
 		}
 	}
-	else
+
+	if (!this->loading1 && !this->loading2 && !this->cancelled && !this->elements1.empty() && !this->elements2.empty())
+	{
+		this->startMerge();
+	}
+
+	this->updateBusy();
+}
+
+//========================================================================================================================
+void CompareDialog::rowsReady(const int done, const int total)
+{
+	std::vector<DcmCompareModel::Row> rows;
+
+	{
+		std::lock_guard<std::mutex> lock(this->pendingMutex);
+		rows.swap(this->pending);
+	}
+
+	this->model->appendRows(std::move(rows));
+	ui.progressBar->setRange(0, total);
+	ui.progressBar->setValue(std::min(done, total));
+	ui.labelDifferences->setText(QString::number(this->model->getDifferenceCount()) + " differences");
+}
+
+//========================================================================================================================
+void CompareDialog::mergeCompleted()
+{
+	this->merging = false;
+	this->streaming = false;
+	ui.labelDifferences->setText(QString::number(this->model->getDifferenceCount()) + " differences" + (this->cancelled ? " (cancelled)" : ""));
+	this->updateBusy();
+}
+
+//========================================================================================================================
+void CompareDialog::exportReport()
+{
+	if (this->loading1 || this->loading2 || this->merging || this->model->rowCount() == 0)
+	{
+		alertFailed("Compare two files first!");
+		return;
+	}
+
+	const QString fileName = QFileDialog::getSaveFileName(this, "Export Report", QString(), "JSON lines (*.jsonl);;CSV (*.csv)");
+
+	if (fileName.isEmpty())
+	{
+		return;
+	}
+
+	DcmCompareReport exported;
+	bool ok = exported.open(fileName);
+
+	for (int i = 0; ok && i < this->model->rowCount(); i++)
+	{
+		exported.write(this->model->getRow(i));
+	}
+
+	if (!exported.close() || !ok)
+	{
+		alertFailed("Failed to write report!");
+	}
+}
+
+//========================================================================================================================
+void CompareDialog::applyOptions()
+{
+	DcmComparePolicy::Options options;
+	options.ignore = ui.lineIgnore->text();
+	options.tolerance = ui.spinTolerance->value();
+	options.uids = ui.checkUids->isChecked();
+	options.padding = ui.checkPadding->isChecked();
+	QString error;
+
+	if (!this->policy.setOptions(options, error))
+	{
+		alertFailed(error.toStdString());
+		return;
+	}
+
+	if (!this->loading1 && !this->loading2 && !this->merging && !this->elements1.empty() && !this->elements2.empty())
 	{
-		clearTable();
-		merge();
+		this->cancelled = false;
+		this->startMerge();
+		this->updateBusy();
 	}
 }
\ No newline at end of file
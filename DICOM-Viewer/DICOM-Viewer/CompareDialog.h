@@ -1,58 +1,102 @@
 #pragma once
 
 #include <QObject>
+#include <QThreadPool>
+#include <atomic>
+#include <mutex>
 #include "ui_CompareDialog.h"
-#include <QtWidgets/qtablewidget.h>
-#include "DcmWidgetElement.h"
+#include <QtWidgets/qtableview.h>
 #include "DcmWidgetElement.h"
+#include "DcmCompareModel.h"
+#include "DcmComparePolicy.h"
 #include "dcmtk/dcmdata/dcfilefo.h"
 #include "dcmtk/dcmdata/dcmetinf.h"
 #include "dcmtk/dcmdata/dctagkey.h"
 
+class DcmCompareReport;
+
 class CompareDialog final : public QWidget
 {
 	Q_OBJECT;
 
 	public:
 		explicit CompareDialog(QWidget* parent);
-		~CompareDialog() = default;
+		~CompareDialog();
+
+	signals:
+		void loadFinished(bool first, bool ok);
+		void rowsAvailable(int done, int total);
+		void mergeFinished();
 
 private:
+		struct Extraction
+		{
+			DcmFileFormat* file;
+			std::vector<DcmWidgetElement>* elements;
+			std::vector<DcmWidgetElement> nestedElements;
+			int depth = 0;
+			int index = 0;
+		};
+
 		Ui::dialogCompare ui{};
 		DcmFileFormat file1;
 		DcmFileFormat file2;
 		std::vector<DcmWidgetElement> elements1;
 		std::vector<DcmWidgetElement> elements2;
-		std::vector<DcmWidgetElement> nestedElements;
-		std::vector<std::tuple<DcmWidgetElement, DcmWidgetElement>> tableElements;
-		int depthRE = 0;
+		std::vector<DcmCompareModel::Row> script;
+		std::vector<DcmCompareModel::Row> pending;
+		std::mutex pendingMutex;
+		DcmCompareModel* model{};
+		DcmCompareFilter* filter{};
+		DcmCompareReport* report{};
+		DcmComparePolicy policy;
+		QThreadPool pool;
+		std::atomic<bool> cancelled{ false };
 		int globalIndex = 0;
-		bool firstFile = false;
-		int loaded = 0;
+		int ignoredDepth = -1;
+		bool loading1 = false;
+		bool loading2 = false;
+		bool merging = false;
+		bool streaming = false;
+		bool keepRows = true;
 
-		void loadFile(DcmFileFormat* file, const QString& fileName, bool first);
+		bool loadFile(DcmFileFormat* file, const QString& fileName, bool first);
+		void startLoad(bool first, const QString& fileName);
+		void startMerge();
+		void flushScript(bool force);
+		void updateBusy() const;
 		static void alertFailed(const std::string& message);
-		void extractData(DcmFileFormat* file);
-		void insertInTable(DcmElement* element, DcmFileFormat* file);
-		void getNestedSequences(const DcmTagKey& tag, DcmSequenceOfItems* sequence, DcmFileFormat* file);
+		void extractData(Extraction& extraction);
+		void insertInTable(DcmElement* element, Extraction& extraction);
+		void getNestedSequences(const DcmTagKey& tag, DcmSequenceOfItems* sequence, Extraction& extraction);
 		static void indent(DcmWidgetElement& element, int depth);
-		void iterateItem(DcmItem *item, int& depth, DcmFileFormat* file);
-		void insert(DcmWidgetElement element, int &index) const;
-		void insertRight(DcmWidgetElement element, int &index) const;
+		void iterateItem(DcmItem *item, int& depth, Extraction& extraction);
 		DcmWidgetElement createElement(DcmElement* element = nullptr, DcmSequenceOfItems* sequence = nullptr, DcmItem* item = nullptr) const;
-		void insertBoth(DcmWidgetElement el1, DcmWidgetElement el2, int &index, int status) const;
+		void insertBoth(const DcmWidgetElement& el1, const DcmWidgetElement& el2, int status);
 		void insertSequence(int status, int& index1, int& index2);
 		void merge();
+		void jumpToDifference(bool forward) const;
 		void clearTable() const;
 		static bool isDelimitation(DcmWidgetElement& el);
-		void populateTableElementsVector();
 		static void precision(std::string& nr, const int& precision);
 		static double getFileSize(const std::string& fileName);
 		static void replace(std::string& str, const std::string& from, const std::string& to);
+		friend class DcmBenchmark;
+		friend class DcmCompareReport;
 
 
 	private slots:
 		void loadFile1();
 		void loadFile2();
 		void findText();
+		void compareImages();
+		void differencesToggled(bool checked) const;
+		void previousDifference() const;
+		void nextDifference() const;
+		void cancelPressed();
+		void exportReport();
+		void applyOptions();
+		void loadCompleted(bool first, bool ok);
+		void rowsReady(int done, int total);
+		void mergeCompleted();
 };
\ No newline at end of file
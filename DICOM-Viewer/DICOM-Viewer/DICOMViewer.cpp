@@ -1,4 +1,17 @@
 #include "DICOMViewer.h"
+#include "DcmStreamTableBuilder.h"
+#include "DcmProfiler.h"
+#include "DcmStringPool.h"
+#include "DiagnosticsDialog.h"
+#include "DcmValueItem.h"
+#include "ValueDialog.h"
+#include "HexInspectorDialog.h"
+#include "StudyBrowserDialog.h"
+#include "MergeDialog.h"
+#include "FrameExplorerDialog.h"
+#include "StatisticsDialog.h"
+#include "DcmPrivateDictionary.h"
+#include <algorithm>
 #include <fstream>
 
 #define SPACE "  "
@@ -20,6 +33,16 @@ DICOMViewer::DICOMViewer(QWidget *parent) : QMainWindow(parent)
 	QHeaderView *verticalHeader = ui.tableWidget->verticalHeader();
 	verticalHeader->setSectionResizeMode(QHeaderView::Fixed);
 	verticalHeader->setDefaultSectionSize(10);
+
+	// a DCMTK style private.dic next to the executable is picked up automatically
+	const QString dictionary = QCoreApplication::applicationDirPath() + "/private.dic";
+	int loaded = 0;
+	QString error;
+
+	if (QFile::exists(dictionary) && !DcmPrivateDictionary::load(dictionary, loaded, error))
+	{
+		this->statusBar()->showMessage(error);
+	}
 }
 
 //========================================================================================================================
@@ -48,22 +71,22 @@ void DICOMViewer::fileTriggered(QAction* qaction)
 
 		if (!fileName.isEmpty())
 		{
-			if (file.loadFile(fileName.toStdString().c_str()).good())
-			{
-				ui.tableWidget->scrollToTop();
-				this->clearTable();
-				this->extractData(file);
-				ui.tableWidget->resizeColumnsToContents();
-				this->setWindowTitle("PixelData DICOM Editor - " + fileName);
-				ui.buttonInsert->setEnabled(true);
-				ui.buttonClose->setEnabled(true);
-				std::string nr = std::to_string(getFileSize(fileName.toStdString()));
-				precision(nr, 2);
-				ui.label->setText("Size: " + QString::fromStdString(nr) + " MB");
-			}
-			else
+			this->openFile(fileName);
+		}
+	}
+
+	else if (option == "Open Streaming")
+	{
+		const QString fileName = QFileDialog::getOpenFileName(this, tr("Open File"), tr(""), tr("DICOM File (*.dcm)"));
+
+		if (!fileName.isEmpty())
+		{
+			DcmProfiler::Scope scope("Open streaming");
+			ui.tableWidget->scrollToTop();
+
+			if (this->openStreaming(fileName))
 			{
-				alertFailed("Failed to open file!");
+				this->showStreamed(fileName);
 			}
 		}
 	}
@@ -71,6 +94,7 @@ void DICOMViewer::fileTriggered(QAction* qaction)
 	else if(option == "Close")
 	{
 		this->clearTable();
+		this->offsetIndex.clear();
 		
 	}
 
@@ -80,12 +104,125 @@ void DICOMViewer::fileTriggered(QAction* qaction)
 		dialog->show();
 	}
 
+	else if (option == "Study Browser")
+	{
+		auto* studyBrowser = new StudyBrowserDialog(nullptr);
+		connect(studyBrowser, &StudyBrowserDialog::instanceSelected, this, &DICOMViewer::openFile);
+		studyBrowser->show();
+	}
+
+	else if (option == "Diagnostics")
+	{
+		auto* diagnosticsDialog = new DiagnosticsDialog(nullptr);
+		diagnosticsDialog->show();
+	}
+
+	else if (option == "Hex Inspector")
+	{
+		this->openHexInspector();
+	}
+
+	else if (option == "Go to Offset")
+	{
+		this->goToOffset();
+	}
+
+	else if (option == "Batch Edit")
+	{
+		auto* batchDialog = new BatchEditDialog(nullptr);
+		batchDialog->show();
+	}
+
+	else if (option == "Three-way Merge")
+	{
+		auto* mergeDialog = new MergeDialog(nullptr);
+		mergeDialog->show();
+	}
+
+	else if (option == "Frame Explorer")
+	{
+		if (this->currentFileName.isEmpty() || this->streamed)
+		{
+			alertFailed("Open a file first!");
+			return;
+		}
+
+		auto* frameDialog = new FrameExplorerDialog(nullptr, this->file.getDataset());
+		frameDialog->show();
+	}
+
+	else if (option == "Statistics")
+	{
+		auto* statisticsDialog = new StatisticsDialog(nullptr, this->statistics);
+		statisticsDialog->show();
+	}
+
+	else if (option == "Load Private Dictionary")
+	{
+		const QString fileName = QFileDialog::getOpenFileName(this, tr("Private Dictionary"), tr(""), tr("DCMTK Dictionary (*.dic);;All Files (*)"));
+
+		if (fileName.isEmpty())
+		{
+			return;
+		}
+
+		int loaded = 0;
+		QString error;
+
+		if (!DcmPrivateDictionary::load(fileName, loaded, error))
+		{
+			alertFailed(error.toStdString());
+			return;
+		}
+
+		this->statusBar()->showMessage(QString::number(loaded) + " private tags loaded from " + fileName);
+
+		if (!this->currentFileName.isEmpty())
+		{
+			this->refresh();
+		}
+	}
+
+	else if (option == "Undo")
+	{
+		if (this->journal.undo())
+		{
+			this->refresh();
+		}
+	}
+
+	else if (option == "Redo")
+	{
+		if (this->journal.redo())
+		{
+			this->refresh();
+		}
+	}
+
+	else if (option == "Begin Batch")
+	{
+		this->journal.beginBatch();
+	}
+
+	else if (option == "Commit Batch")
+	{
+		this->journal.commitBatch();
+		this->refresh();
+	}
+
 	else if (option == "Save as")
 	{
+		if (this->streamed)
+		{
+			alertFailed("File was opened in streaming mode and is read-only!");
+			return;
+		}
+
 		const QString fileName = QFileDialog::getSaveFileName(this,tr("Save File"),tr(""), tr("DICOM File (*.dcm)"));
+
 		if (!fileName.isEmpty())
 		{
-			if (!file.saveFile(fileName.toStdString().c_str()).good())
+			if (!fastSave.saveFile(fileName.toStdString()).good())
 			{
 				alertFailed("Failed to save!");
 			}
@@ -94,10 +231,30 @@ void DICOMViewer::fileTriggered(QAction* qaction)
 }
 
 //========================================================================================================================
-void DICOMViewer::extractData(DcmFileFormat file)
+void DICOMViewer::extractData(DcmFileFormat& file)
 {
+	DcmProfiler::Scope scope("Extract data");
+	const long long start = DcmProfiler::now();
+	this->phase = PhaseTotals();
+
 	DcmMetaInfo* metaInfo = file.getMetaInfo();
 	DcmDataset* dataSet = file.getDataset();
+	size_t rows = 0;
+	size_t nested = 0;
+
+	// nested rows are reserved up front as well, growing inside the arena would keep every old buffer alive
+	for (DcmItem* item : { OFstatic_cast(DcmItem*, metaInfo), OFstatic_cast(DcmItem*, dataSet) })
+	{
+		for (DcmObject* object = item->nextInContainer(nullptr); object; object = item->nextInContainer(object))
+		{
+			const size_t count = countRows(object);
+			rows += count;
+			nested = std::max(nested, count);
+		}
+	}
+
+	this->elements.reserve(this->elements.size() + rows);
+	this->nestedElements.reserve(nested);
 
 	for (unsigned long i = 0; i < metaInfo->card(); i++)
 	{
@@ -109,6 +266,131 @@ void DICOMViewer::extractData(DcmFileFormat file)
 		this->insertInTable(dataSet->getElement(i));
 	}
 
+	this->reportPhase(start);
+}
+
+//========================================================================================================================
+void DICOMViewer::openFile(const QString& fileName)
+{
+	DcmProfiler::Scope scope("Open file");
+	OFCondition status;
+
+	{
+		DcmProfiler::Scope loadScope("Load file");
+		status = file.loadFile(fileName.toStdString().c_str());
+	}
+
+
+	if (status.good())
+	{
+		ui.tableWidget->scrollToTop();
+		this->clearTable();
+		this->extractData(file);
+		this->fastSave.setSource(&file, fileName.toStdString());
+		this->journal.setTarget(&file, &fastSave);
+		this->streamed = false;
+		this->currentFileName = fileName;
+
+		{
+			DcmProfiler::Scope indexScope("Build offset index");
+
+			const bool indexed = this->offsetIndex.build(QFile::encodeName(fileName).toStdString());
+			DcmProfiler::instance().count("Bytes read by offset index", this->offsetIndex.getBytesRead());
+
+			if (indexed)
+			{
+				std::map<DcmTagKey, DcmFastSave::Range> ranges;
+				this->offsetIndex.getTopLevelRanges(ranges);
+				this->fastSave.setRanges(ranges, this->offsetIndex.getDatasetOffset());
+				this->locateElements();
+			}
+		}
+
+		ui.tableWidget->resizeColumnsToContents();
+		this->setWindowTitle("PixelData DICOM Editor - " + fileName);
+		ui.buttonInsert->setEnabled(true);
+		ui.buttonClose->setEnabled(true);
+		std::string nr = std::to_string(getFileSize(fileName.toStdString()));
+		precision(nr, 2);
+		ui.label->setText("Size: " + QString::fromStdString(nr) + " MB");
+	}
+	else if (this->openStreaming(fileName))
+	{
+		this->showStreamed(fileName);
+		alertFailed("Failed to open file: " + std::string(status.text()) + ". Showing what could be recovered, read-only.");
+	}
+}
+
+//========================================================================================================================
+bool DICOMViewer::openStreaming(const QString& fileName)
+{
+	DcmProfiler::Scope scope("Stream parse");
+	this->clearTable();
+	this->releaseElements();
+
+	// the row count is only known after parsing, so rows grow on the heap where old buffers are freed, and the arena receives them once at their final size
+	DcmElementList rows(std::pmr::new_delete_resource());
+	DcmStreamTableBuilder builder(rows);
+	DcmStreamParser parser;
+	parser.setTolerant(true);
+	this->file.clear();
+	this->fastSave.clear();
+	this->journal.clear();
+	this->offsetIndex.clear();
+
+	if (!parser.parseFile(fileName.toStdString(), builder))
+	{
+		alertFailed("Failed to open file: " + parser.getError() + " at offset " + std::to_string(parser.getErrorOffset()));
+
+		if (rows.empty())
+		{
+			return false;
+		}
+	}
+
+	this->streamed = true;
+	this->currentFileName = fileName;
+	DcmProfiler::instance().count("Bytes read by stream parser", parser.getBytesRead());
+	const long long start = DcmProfiler::now();
+	this->phase = PhaseTotals();
+	const size_t count = rows.size();
+	this->elements.reserve(count);
+
+	for (auto& row : rows)
+	{
+		indent(row, row.getDepth());
+		this->insert(row, this->globalIndex);
+		row.setTableIndex(this->globalIndex);
+		this->statistics.addRow(row);
+		this->elements.push_back(std::move(row));
+		this->globalIndex++;
+	}
+
+	rows = DcmElementList(std::pmr::new_delete_resource());
+	this->reportPhase(start);
+	const std::vector<DcmStreamError>& errors = parser.getErrors();
+
+	if (!errors.empty())
+	{
+		this->statusBar()->showMessage(QString("%1 damaged region(s), first at offset %2: %3")
+			.arg(errors.size()).arg(errors.front().offset).arg(QString::fromStdString(errors.front().message)));
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+void DICOMViewer::showStreamed(const QString& fileName)
+{
+	ui.tableWidget->resizeColumnsToContents();
+	this->setWindowTitle("PixelData DICOM Editor - " + fileName + " (read-only)");
+	ui.buttonInsert->setEnabled(false);
+	ui.buttonEdit->setEnabled(false);
+	ui.buttonDelete->setEnabled(false);
+	ui.buttonClose->setEnabled(true);
+	std::string nr = std::to_string(getFileSize(fileName.toStdString()));
+	precision(nr, 2);
+	ui.label->setText("Size: " + QString::fromStdString(nr) + " MB");
 }
 
 //========================================================================================================================
@@ -121,15 +403,14 @@ void DICOMViewer::insertInTable(DcmElement* element)
 
 	if (!this->nestedElements.empty())
 	{
-		for (auto widget_element : this->nestedElements)
+		for (auto& widget_element : this->nestedElements)
 		{
 			indent(widget_element, widget_element.getDepth());
 			this->insert(widget_element, globalIndex);
-			DcmWidgetElement copyElement = DcmWidgetElement(widget_element);
-			copyElement.setTableIndex(globalIndex);
-			this->elements.push_back(copyElement);
+			widget_element.setTableIndex(globalIndex);
+			this->statistics.addRow(widget_element);
+			this->elements.push_back(std::move(widget_element));
 			this->globalIndex++;
-
 		}
 
 		this->nestedElements.clear();
@@ -140,29 +421,35 @@ void DICOMViewer::insertInTable(DcmElement* element)
 		DcmWidgetElement widgetElement = createElement(element,nullptr,nullptr);
 		widgetElement.setItemTag(widgetElement.getItemTag().toUpper());
 		this->insert(widgetElement, globalIndex);
-		DcmWidgetElement copyElement = DcmWidgetElement(widgetElement);
-		copyElement.setTableIndex(globalIndex);
-		this->elements.push_back(copyElement);
+		widgetElement.setTableIndex(globalIndex);
+		this->statistics.addRow(widgetElement);
+		this->elements.push_back(std::move(widgetElement));
 		this->globalIndex++;
 	}
 }
 
 //========================================================================================================================
-void DICOMViewer::repopulate(std::vector<DcmWidgetElement> source) const
+void DICOMViewer::repopulate(const DcmElementList& source) const
 {
 	ui.tableWidget->clearContents();
-	for (int i = ui.tableWidget->rowCount(); i >= 0; i--)
+	ui.tableWidget->setRowCount(0);
+
+	for (unsigned long i = 0; i < source.size(); i++)
 	{
-		ui.tableWidget->removeRow(i);
+		this->insert(source[i], i);
 	}
+}
+
+//========================================================================================================================
+void DICOMViewer::repopulate(const std::vector<const DcmWidgetElement*>& source) const
+{
+	ui.tableWidget->clearContents();
+	ui.tableWidget->setRowCount(0);
 
 	for (unsigned long i = 0; i < source.size(); i++)
 	{
-		const DcmWidgetElement element = DcmWidgetElement(source[i]);
-		
-		this->insert(element, i);
+		this->insert(*source[i], i);
 	}
-	
 }
 
 //========================================================================================================================
@@ -208,10 +495,10 @@ void DICOMViewer::getNestedSequences(const DcmTagKey& tag, DcmSequenceOfItems* s
 				}
 
 				DcmWidgetElement widgetElementDelim = DcmWidgetElement(
-					QString("(FFFE,E00D)"),
+					QStringLiteral("(FFFE,E00D)"),
 					QString(""), QString("0"),
 					QString("0"),
-					QString("SequenceDelimitationItem"),
+					QStringLiteral("SequenceDelimitationItem"),
 					QString(""));
 				widgetElementDelim.setDepth(0);
 				this->nestedElements.push_back(widgetElementDelim);
@@ -237,10 +524,10 @@ void DICOMViewer::getNestedSequences(const DcmTagKey& tag, DcmSequenceOfItems* s
 			this->nestedElements.push_back(widgetElement2);
 			this->iterateItem(sequence->getItem(i), this->depthRE);
 			DcmWidgetElement widgetElementDelim = DcmWidgetElement(
-				QString("(FFFE,E00D)"),
+				QStringLiteral("(FFFE,E00D)"),
 				QString(""), QString("0"),
 				QString("0"),
-				QString("ItemDelimitationItem"),
+				QStringLiteral("ItemDelimitationItem"),
 				QString(""));
 			this->depthRE--;
 			widgetElementDelim.setDepth(this->depthRE);
@@ -248,11 +535,11 @@ void DICOMViewer::getNestedSequences(const DcmTagKey& tag, DcmSequenceOfItems* s
 		}
 
 		DcmWidgetElement widgetElementDelim = DcmWidgetElement(
-			QString("(FFFE,E0DD)"),
+			QStringLiteral("(FFFE,E0DD)"),
 			QString(""),
 			QString("0"),
 			QString("0"),
-			QString("SequenceDelimitationItem"),
+			QStringLiteral("SequenceDelimitationItem"),
 			QString(""));
 		this->depthRE--;
 		widgetElementDelim.setDepth(this->depthRE);
@@ -283,13 +570,51 @@ void DICOMViewer::iterateItem(DcmItem * item,int& depth)
 	}
 }
 
+//========================================================================================================================
+size_t DICOMViewer::countRows(DcmObject* object)
+{
+	if (object->ident() == EVR_PixelData)
+	{
+		auto* pixelData = OFstatic_cast(DcmPixelData*, object);
+		E_TransferSyntax xfer = EXS_Unknown;
+		const DcmRepresentationParameter* param = nullptr;
+		DcmPixelSequence* pixSeq = nullptr;
+		pixelData->getOriginalRepresentationKey(xfer, param);
+
+		if (pixelData->getEncapsulatedRepresentation(xfer, param, pixSeq).good() && pixSeq != nullptr)
+		{
+			return pixSeq->card() + 2;
+		}
+	}
+
+	if (object->ident() != EVR_SQ)
+	{
+		return 1;
+	}
+
+	// the sequence, every item and their delimiters take a row each
+	auto* sequence = OFstatic_cast(DcmSequenceOfItems*, object);
+	size_t rows = 2;
+
+	for (DcmObject* item = sequence->nextInContainer(nullptr); item; item = sequence->nextInContainer(item))
+	{
+		rows += 2;
+
+		for (DcmObject* child = item->nextInContainer(nullptr); child; child = item->nextInContainer(child))
+		{
+			rows += countRows(child);
+		}
+	}
+
+	return rows;
+}
+
 //========================================================================================================================
 void DICOMViewer::clearTable()
 {
 	if (ui.tableWidget->rowCount())
 	{
-		this->nestedElements.clear();
-		this->elements.clear();
+		this->releaseElements();
 		this->globalIndex = 0;
 
 
@@ -312,6 +637,26 @@ void DICOMViewer::clearTable()
 	}
 }
 
+//========================================================================================================================
+void DICOMViewer::releaseElements()
+{
+	this->nestedElements = DcmElementList(&this->arena);
+	this->elements = DcmElementList(&this->arena);
+	this->arena.release();
+	this->statistics.clear();
+}
+
+//========================================================================================================================
+void DICOMViewer::reportPhase(const long long start) const
+{
+	DcmProfiler& profiler = DcmProfiler::instance();
+	profiler.addSpan("Create elements", start, this->phase.create);
+	profiler.addSpan("Insert rows", start, this->phase.insert);
+	profiler.count("Elements created", this->phase.created);
+	profiler.count("Rows inserted", this->phase.inserted);
+	this->phase = PhaseTotals();
+}
+
 //========================================================================================================================
 void DICOMViewer::alertFailed(const std::string& message)
 {
@@ -341,57 +686,28 @@ void DICOMViewer::indent(DcmWidgetElement & element, int depth)
 //========================================================================================================================
 DcmWidgetElement DICOMViewer::createElement(DcmElement* element, DcmSequenceOfItems* sequence, DcmItem* item) const
 {
+	DcmProfiler::Timer timer(this->phase.create);
+	this->phase.created++;
+
 	if (element)
 	{
 		DcmTagKey tagKey = DcmTagKey(
 			OFstatic_cast(Uint16, element->getGTag()), 
 			OFstatic_cast(Uint16, element->getETag()));
-		DcmTag tagName = DcmTag(tagKey);
-		DcmVR vr = DcmVR(element->getVR());
-		std::string finalString;
-
-		if(tagKey != DCM_PixelData && element->getLengthField()<=50)
-		{
-			OFString value;
-			element->getOFStringArray(value, true);
-			finalString = value.c_str();
-			replace(finalString, "\\", " ");
-		}
-
-		else
-		{
-			for (int i = 0; i < 10; i++)
-			{
-				OFString value;
-				element->getOFString(value, i, false);
-				finalString.append(value.c_str());
-				finalString.append(" ");
-			}
-		}
 
 	
-		if (strcmp(vr.getVRName(), "??")==0 )
-		{
-			DcmWidgetElement widgetElement = DcmWidgetElement(
-				QString::fromStdString(tagKey.toString().c_str()),
-				QString::fromStdString(""),
-				QString::fromStdString(std::to_string(element->getVM())),
-				QString::fromStdString(std::to_string(element->getLength())),
-				"",
-				QString::fromStdString(finalString));
-			
-			return widgetElement;
-		}
-		
+		const DcmStringPool::Descriptor& descriptor = DcmStringPool::descriptor(tagKey, element->getVR());
+		DcmPrivateDictionary::Entry privateEntry;
+		const bool isPrivate = DcmPrivateDictionary::find(element, privateEntry);
 		DcmWidgetElement widgetElement = DcmWidgetElement(
-			QString::fromStdString(tagKey.toString().c_str()),
-			QString::fromStdString(vr.getVRName()),
-			QString::fromStdString(std::to_string(element->getVM())),
-			QString::fromStdString(std::to_string(element->getLength())),
-			tagName.getTagName(),
-			QString::fromStdString(finalString));
-
-
+			descriptor.tag,
+			isPrivate && (descriptor.vr.isEmpty() || descriptor.vr == "UN") ? privateEntry.vr : descriptor.vr,
+			DcmStringPool::number(element->getVM()),
+			DcmStringPool::number(element->getLength()),
+			isPrivate ? privateEntry.name : descriptor.description,
+			QString());
+
+		widgetElement.setSource(element);
 		return widgetElement;
 	}
 	
@@ -400,52 +716,15 @@ DcmWidgetElement DICOMViewer::createElement(DcmElement* element, DcmSequenceOfIt
 		DcmTagKey tagKey = DcmTagKey(
 			OFstatic_cast(Uint16, sequence->getGTag()), 
 			OFstatic_cast(Uint16, sequence->getETag()));
-		DcmTag tagName = DcmTag(tagKey);
-		DcmVR vr = DcmVR(sequence->getVR());
-		std::string finalString;
-
-		if (tagKey != DCM_PixelData && sequence->getLengthField()<= 50)
-		{
-			OFString value;
-			sequence->getOFStringArray(value, true);
-			finalString = value.c_str();
-			replace(finalString, "\\", " ");
-		}
-
-		
-		else
-		{
-			for (int i = 0; i < 10; i++)
-			{
-				OFString value;
-				sequence->getOFString(value, i, false);
-				finalString.append(value.c_str());
-				finalString.append(" ");
-			}
-
-		}
-
-		if (strcmp(vr.getVRName(), "??") == 0)
-		{
-			DcmWidgetElement widgetElement = DcmWidgetElement(
-				QString::fromStdString(tagKey.toString().c_str()),
-				QString::fromStdString(""),
-				QString::fromStdString(std::to_string(sequence->getVM())),
-				QString::fromStdString(std::to_string(sequence->getLength())),
-				"",
-				QString::fromStdString(finalString));
-
-			return widgetElement;
-		}
 
+		const DcmStringPool::Descriptor& descriptor = DcmStringPool::descriptor(tagKey, sequence->getVR());
 		DcmWidgetElement widgetElement = DcmWidgetElement(
-			QString::fromStdString(tagKey.toString().c_str()),
-			QString::fromStdString(vr.getVRName()),
-			QString::fromStdString(std::to_string(sequence->getVM())),
-			QString::fromStdString(std::to_string(sequence->getLength())),
-			tagName.getTagName(),
-			QString::fromStdString(finalString));
-
+			descriptor.tag,
+			descriptor.vr,
+			DcmStringPool::number(sequence->getVM()),
+			DcmStringPool::number(sequence->getLength()),
+			descriptor.description,
+			QString());
 
 		return widgetElement;
 	}
@@ -455,31 +734,16 @@ DcmWidgetElement DICOMViewer::createElement(DcmElement* element, DcmSequenceOfIt
 		DcmTagKey tagKey = DcmTagKey(
 			OFstatic_cast(Uint16, item->getGTag()),
 			OFstatic_cast(Uint16, item->getETag()));
-		DcmTag tagName = DcmTag(tagKey);
-		DcmVR vr = DcmVR(item->getVR());
 
 
-		if (strcmp(vr.getVRName(), "??") == 0)
-		{
-			DcmWidgetElement widgetElement = DcmWidgetElement(
-				QString::fromStdString(tagKey.toString().c_str()),
-				QString::fromStdString(""),
-				QString::fromStdString(std::to_string(item->getVM())),
-				QString::fromStdString(std::to_string(item->getLength())),
-				"",
-				QString::fromStdString(""));
-
-			return widgetElement;
-		}
-
+		const DcmStringPool::Descriptor& descriptor = DcmStringPool::descriptor(tagKey, item->getVR());
 		DcmWidgetElement widgetElement = DcmWidgetElement(
-			QString::fromStdString(tagKey.toString().c_str()),
-			QString::fromStdString(vr.getVRName()),
-			QString::fromStdString(std::to_string(item->getVM())),
-			QString::fromStdString(std::to_string(item->getLength())),
-			tagName.getTagName(),
-			QString::fromStdString(""));
-
+			descriptor.tag,
+			descriptor.vr,
+			DcmStringPool::number(item->getVM()),
+			DcmStringPool::number(item->getLength()),
+			descriptor.description,
+			QString());
 
 		return widgetElement;
 	}
@@ -490,15 +754,25 @@ DcmWidgetElement DICOMViewer::createElement(DcmElement* element, DcmSequenceOfIt
 }
 
 //========================================================================================================================
-void DICOMViewer::insert(DcmWidgetElement element, unsigned long &index) const
+void DICOMViewer::insert(const DcmWidgetElement& element, const unsigned long index) const
 {
+	DcmProfiler::Timer timer(this->phase.insert);
+	this->phase.inserted++;
 	ui.tableWidget->insertRow(index);
 	ui.tableWidget->setItem(index, 0, new QTableWidgetItem(element.getItemTag()));
 	ui.tableWidget->setItem(index, 1, new QTableWidgetItem(element.getItemVR()));
 	ui.tableWidget->setItem(index, 2, new QTableWidgetItem(element.getItemVM()));
 	ui.tableWidget->setItem(index, 3, new QTableWidgetItem(element.getItemLength()));
 	ui.tableWidget->setItem(index, 4, new QTableWidgetItem(element.getItemDescription()));
-	ui.tableWidget->setItem(index, 5, new QTableWidgetItem(element.getItemValue()));
+	ui.tableWidget->setItem(index, 5, new DcmValueItem(element));
+
+	if (element.isCorrupt())
+	{
+		for (int column = 0; column < ui.tableWidget->columnCount(); column++)
+		{
+			ui.tableWidget->item(index, column)->setBackground(QColor(255, 200, 200));
+		}
+	}
 }
 
 //========================================================================================================================
@@ -542,19 +816,21 @@ void DICOMViewer::getTagKeyOfSequence(const int row, DcmTagKey* returnKey, int*
 //========================================================================================================================
 void DICOMViewer::findText()
 {
+	DcmProfiler::Scope scope("Find text");
+
 	const QString text = ui.lineEdit->text();
 
 	if (!text.isEmpty())
 	{
 		if (!this->elements.empty())
 		{
-			std::vector<DcmWidgetElement> result;
+			std::vector<const DcmWidgetElement*> result;
 
-			for (DcmWidgetElement element : this->elements)
+			for (const auto& element : this->elements)
 			{
 				if (element.checkIfContains(text))
 				{
-					result.push_back(element);
+					result.push_back(&element);
 				}
 			}
 
@@ -572,6 +848,27 @@ void DICOMViewer::findText()
 //========================================================================================================================
 void DICOMViewer::tableClicked(int row, int collumn)
 {
+	const DcmWidgetElement* located = this->elementAtRow(row);
+
+	if (located && located->hasLocation())
+	{
+		this->statusBar()->showMessage(QString("Offset %1 (0x%2)  Header %3 bytes  Value %4 bytes")
+			.arg(located->getOffset()).arg(located->getOffset(), 0, 16).arg(located->getHeaderLength()).arg(located->getValueLength()));
+	}
+
+	else
+	{
+		this->statusBar()->clearMessage();
+	}
+
+	if (this->streamed)
+	{
+		ui.buttonEdit->setEnabled(false);
+		ui.buttonDelete->setEnabled(false);
+		ui.buttonInsert->setEnabled(false);
+		return;
+	}
+
 	QList<QTableWidgetItem*> selectedTags = ui.tableWidget->selectedItems();
 
 	DcmWidgetElement element = DcmWidgetElement(selectedTags[0]->text().trimmed(), selectedTags[1]->text(),
@@ -579,7 +876,7 @@ void DICOMViewer::tableClicked(int row, int collumn)
 
 	if (!selectedTags.empty())
 	{
-		for (auto elementV : this->elements)
+		for (const auto& elementV : this->elements)
 		{
 			if ( (element == elementV && !shouldModify(element)) )
 			{
@@ -622,6 +919,21 @@ void DICOMViewer::tableClicked(int row, int collumn)
 	ui.buttonInsert->setEnabled(true);
 }
 
+//========================================================================================================================
+void DICOMViewer::tableDoubleClicked(const int row, int collumn)
+{
+	auto* valueItem = dynamic_cast<DcmValueItem*>(ui.tableWidget->item(row, 5));
+
+	if (!valueItem || !valueItem->getSource())
+	{
+		return;
+	}
+
+	auto* valueDialog = new ValueDialog(nullptr, valueItem->getSource(), ui.tableWidget->item(row, 0)->text().trimmed() + " " + ui.tableWidget->item(row, 4)->text());
+	valueDialog->exec();
+	delete valueDialog;
+}
+
 //========================================================================================================================
 void DICOMViewer::closeButtonClicked()
 {
@@ -645,7 +957,7 @@ void DICOMViewer::editClicked()
 }
 
 //========================================================================================================================
-bool DICOMViewer::deleteElementFromFile(DcmSequenceOfItems* sequence, DcmWidgetElement element, QList<DcmWidgetElement> list)
+bool DICOMViewer::deleteElementFromFile(DcmSequenceOfItems* sequence, const DcmWidgetElement& element, QList<DcmWidgetElement>& list, DcmEditJournal::Path path)
 {
 	int count = -1;
 	int i = list.size() - 1;
@@ -661,7 +973,7 @@ bool DICOMViewer::deleteElementFromFile(DcmSequenceOfItems* sequence, DcmWidgetE
 	{
 		count--;
 
-		if (!sequence->getParentItem()->findAndDeleteSequenceItem(sequence->getTag().getBaseTag(), count).good())
+		if (!this->journal.removeItem(path, sequence->getTag().getBaseTag(), count).good())
 		{
 			alertFailed("Failed!");
 			return false;
@@ -671,10 +983,11 @@ bool DICOMViewer::deleteElementFromFile(DcmSequenceOfItems* sequence, DcmWidgetE
 	}
 
 	DcmItem* item = sequence->getItem(count);
+	path.emplace_back(sequence->getTag().getBaseTag(), count);
 
 	if (list[i] == element)
 	{
-		if (!item->findAndDeleteElement(element.extractTagKey(), false, false).good())
+		if (!this->journal.removeElement(path, element.extractTagKey()).good())
 		{
 			alertFailed("Failed!");
 			return false;
@@ -693,7 +1006,7 @@ bool DICOMViewer::deleteElementFromFile(DcmSequenceOfItems* sequence, DcmWidgetE
 		if (item->findAndGetSequence(list[i].extractTagKey(), seq, false, false).good())
 		{
 			list.removeLast();
-			return deleteElementFromFile(seq, element, list);
+			return deleteElementFromFile(seq, element, list, std::move(path));
 		}
 
 		else
@@ -705,7 +1018,7 @@ bool DICOMViewer::deleteElementFromFile(DcmSequenceOfItems* sequence, DcmWidgetE
 }
 
 //========================================================================================================================
-bool DICOMViewer::modifyValue(DcmSequenceOfItems* sequence, DcmWidgetElement element, QList<DcmWidgetElement> list, const QString& value)
+bool DICOMViewer::modifyValue(DcmSequenceOfItems* sequence, const DcmWidgetElement& element, QList<DcmWidgetElement>& list, const QString& value, DcmEditJournal::Path path)
 {
 	int count = -1;
 	int i = list.size() - 1;
@@ -718,23 +1031,13 @@ bool DICOMViewer::modifyValue(DcmSequenceOfItems* sequence, DcmWidgetElement ele
 	}
 
 	DcmItem* item = sequence->getItem(count);
+	path.emplace_back(sequence->getTag().getBaseTag(), count);
 
 	if (list[i] == element)
 	{
-		DcmElement* el;
-
-		if (item->findAndGetElement(element.extractTagKey(), el, false, false).good())
+		if (this->journal.modifyValue(path, element.extractTagKey(), value.toStdString().c_str()).good())
 		{
-			if (el->putString(value.toStdString().c_str()).good())
-			{
-				return true;
-			}
-
-			else
-			{
-				alertFailed("Failed!");
-				return false;
-			}
+			return true;
 		}
 
 		else
@@ -751,7 +1054,7 @@ bool DICOMViewer::modifyValue(DcmSequenceOfItems* sequence, DcmWidgetElement ele
 		if (item->findAndGetSequence(list[i].extractTagKey(), seq, false, false).good())
 		{
 			list.removeLast();
-			return modifyValue(seq, element, list, value);
+			return modifyValue(seq, element, list, value, std::move(path));
 		}
 
 		else
@@ -763,7 +1066,7 @@ bool DICOMViewer::modifyValue(DcmSequenceOfItems* sequence, DcmWidgetElement ele
 }
 
 //========================================================================================================================
-bool DICOMViewer::insertElement(DcmSequenceOfItems * sequence, DcmWidgetElement element, DcmWidgetElement insertElement, QList<DcmWidgetElement> list) const
+bool DICOMViewer::insertElement(DcmSequenceOfItems * sequence, const DcmWidgetElement& element, const DcmWidgetElement& insertElement, QList<DcmWidgetElement>& list, DcmEditJournal::Path path)
 {
 	int count = -1;
 	int i = list.size() - 1;
@@ -778,9 +1081,9 @@ bool DICOMViewer::insertElement(DcmSequenceOfItems * sequence, DcmWidgetElement
 	if (list.empty())
 	{
 		count--;
-		DcmItem* item = sequence->getItem(count);
+		path.emplace_back(sequence->getTag().getBaseTag(), count);
 
-		if (!item->putAndInsertString(insertElement.extractTagKey(), insertElement.getItemValue().toStdString().c_str(), false).good())
+		if (!this->journal.insertString(path, insertElement.extractTagKey(), insertElement.getItemValue().toStdString().c_str()).good())
 		{
 			alertFailed("Failed!");
 			return false;
@@ -790,13 +1093,13 @@ bool DICOMViewer::insertElement(DcmSequenceOfItems * sequence, DcmWidgetElement
 	}
 
 	DcmItem* item = sequence->getItem(count);
+	path.emplace_back(sequence->getTag().getBaseTag(), count);
 
 	if (list[i] == element)
 	{
 		if (insertElement.getItemVR() == "na")
 		{
-			DcmItem* it = new DcmItem(DcmTag(insertElement.extractTagKey()));
-			if (!item->insertSequenceItem(element.extractTagKey(), it).good())
+			if (!this->journal.insertItem(path, element.extractTagKey(), insertElement.extractTagKey()).good())
 			{
 				alertFailed("Failed!");
 				return false;
@@ -807,7 +1110,7 @@ bool DICOMViewer::insertElement(DcmSequenceOfItems * sequence, DcmWidgetElement
 
 		else
 		{
-			if (!item->putAndInsertString(insertElement.extractTagKey(), insertElement.getItemValue().toStdString().c_str(), false).good())
+			if (!this->journal.insertString(path, insertElement.extractTagKey(), insertElement.getItemValue().toStdString().c_str()).good())
 			{
 				alertFailed("Failed!");
 				return false;
@@ -824,7 +1127,7 @@ bool DICOMViewer::insertElement(DcmSequenceOfItems * sequence, DcmWidgetElement
 		if (item->findAndGetSequence(list[i].extractTagKey(), seq, false, false).good())
 		{
 			list.removeLast();
-			return this->insertElement(seq, element, insertElement, list);
+			return this->insertElement(seq, element, insertElement, list, std::move(path));
 		}
 
 		else
@@ -836,8 +1139,9 @@ bool DICOMViewer::insertElement(DcmSequenceOfItems * sequence, DcmWidgetElement
 }
 
 //========================================================================================================================
-void DICOMViewer::createSimpleEditDialog(DcmWidgetElement element)
+void DICOMViewer::createSimpleEditDialog(const DcmWidgetElement& selected)
 {
+	DcmWidgetElement element = selected;
 	element.calculateDepthFromTag();
 	auto* editDialog = new EditDialogSimple(nullptr);
 	editDialog->setValue(element.getItemValue());
@@ -863,30 +1167,18 @@ void DICOMViewer::createSimpleEditDialog(DcmWidgetElement element)
 			{
 				list.removeLast();
 
-				if (modifyValue(sequence, element, list,result))
+				if (modifyValue(sequence, element, list, result, DcmEditJournal::Path()))
 				{
-					clearTable();
-					extractData(file);
+					this->valueModified(element.getTableIndex(), result);
 				}
 			}
 		}
 
 		else
 		{
-			DcmElement* el;
-
-			if (file.getDataset()->findAndGetElement(element.extractTagKey(), el, false, false).good())
+			if (this->journal.modifyValue(DcmEditJournal::Path(), element.extractTagKey(), result.toStdString().c_str()).good())
 			{
-				if (el->putString(result.toStdString().c_str()).good())
-				{
-					clearTable();
-					extractData(file);
-				}
-
-				else
-				{
-					alertFailed("Failed!");
-				}
+				this->valueModified(element.getTableIndex(), result);
 			}
 
 			else
@@ -900,7 +1192,175 @@ void DICOMViewer::createSimpleEditDialog(DcmWidgetElement element)
 }
 
 //========================================================================================================================
-void DICOMViewer::generatePathToRoot(DcmWidgetElement element, int row, QList<DcmWidgetElement> *elements)
+void DICOMViewer::valueModified(const int tableIndex, const QString& value)
+{
+	if (this->journal.inBatch() && tableIndex >= 0 && tableIndex < static_cast<int>(this->elements.size()))
+	{
+		this->elements[tableIndex].setValue(value);
+		ui.tableWidget->item(ui.tableWidget->currentRow(), 5)->setText(value);
+		this->scrollPosition = ui.tableWidget->model()->index(ui.tableWidget->currentRow(), 0);
+		return;
+	}
+
+	this->refresh();
+}
+
+//========================================================================================================================
+void DICOMViewer::refresh()
+{
+	if (this->streamed)
+	{
+		return;
+	}
+
+	clearTable();
+	extractData(file);
+	locateElements();
+}
+
+//========================================================================================================================
+void DICOMViewer::openHexInspector()
+{
+	const int row = ui.tableWidget->currentRow();
+
+	if (row < 0 || this->currentFileName.isEmpty())
+	{
+		alertFailed("Select an element first!");
+		return;
+	}
+
+	if (this->fastSave.isDirty())
+	{
+		alertFailed("The file has unsaved changes, the inspector shows the bytes on disk!");
+		return;
+	}
+
+	const DcmWidgetElement* element = this->elementAtRow(row);
+
+	if (!element || !element->hasLocation())
+	{
+		alertFailed("Element has no payload in the file on disk!");
+		return;
+	}
+
+	auto* hexDialog = new HexInspectorDialog(nullptr, this->currentFileName, element->getOffset(), element->getHeaderLength() + element->getValueLength(),
+		element->getItemTag().trimmed() + " " + element->getItemDescription());
+
+	if (!hexDialog->isOpen())
+	{
+		delete hexDialog;
+		alertFailed("Failed to open file!");
+		return;
+	}
+
+	hexDialog->show();
+}
+
+//========================================================================================================================
+void DICOMViewer::goToOffset()
+{
+	if (this->elements.empty())
+	{
+		alertFailed("Open a file first!");
+		return;
+	}
+
+	bool ok = false;
+	const QString text = QInputDialog::getText(this, tr("Go to Offset"), tr("Byte offset (decimal or 0x hex):"), QLineEdit::Normal, QString(), &ok).trimmed();
+
+	if (!ok || text.isEmpty())
+	{
+		return;
+	}
+
+	const qint64 target = text.startsWith("0x", Qt::CaseInsensitive) ? text.mid(2).toLongLong(&ok, 16) : text.toLongLong(&ok, 10);
+
+	if (!ok || target < 0)
+	{
+		alertFailed("Invalid offset!");
+		return;
+	}
+
+	// rows are in file order, so the last element spanning the offset is the innermost one
+	int found = -1;
+
+	for (unsigned long i = 0; i < this->elements.size(); i++)
+	{
+		const DcmWidgetElement& element = this->elements[i];
+
+		if (element.hasLocation() && target >= element.getOffset() && target < element.getOffset() + element.getHeaderLength() + element.getValueLength())
+		{
+			found = static_cast<int>(i);
+		}
+	}
+
+	if (found < 0)
+	{
+		alertFailed("No element covers offset " + std::to_string(target) + "!");
+		return;
+	}
+
+	if (!ui.lineEdit->text().isEmpty())
+	{
+		ui.lineEdit->clear();
+		repopulate(this->elements);
+	}
+
+	ui.tableWidget->selectRow(found);
+	ui.tableWidget->scrollToItem(ui.tableWidget->item(found, 0), QAbstractItemView::PositionAtCenter);
+	this->tableClicked(found, 0);
+}
+
+//========================================================================================================================
+void DICOMViewer::locateElements()
+{
+	if (this->offsetIndex.empty() || this->fastSave.isDirty())
+	{
+		return;
+	}
+
+	std::map<DcmTagKey, unsigned long> occurrences;
+
+	for (auto& element : this->elements)
+	{
+		const DcmTagKey tag = element.extractTagKey();
+
+		if (tag == DCM_ItemDelimitationItem || tag == DCM_SequenceDelimitationItem)
+		{
+			continue;
+		}
+
+		const DcmOffsetIndex::Entry* entry = this->offsetIndex.find(tag, occurrences[tag]++);
+
+		if (entry)
+		{
+			element.setLocation(entry->offset, entry->headerLength, entry->valueLength);
+		}
+	}
+}
+
+//========================================================================================================================
+const DcmWidgetElement* DICOMViewer::elementAtRow(const int row) const
+{
+	if (row < 0 || row >= ui.tableWidget->rowCount() || !ui.tableWidget->item(row, 0))
+	{
+		return nullptr;
+	}
+
+	DcmWidgetElement element = DcmWidgetElement(ui.tableWidget->item(row, 0)->text().trimmed(), ui.tableWidget->item(row, 1)->text(),
+		ui.tableWidget->item(row, 2)->text(), ui.tableWidget->item(row, 3)->text(), ui.tableWidget->item(row, 4)->text(), ui.tableWidget->item(row, 5)->text());
+	element.calculateTableIndex(currentRow(element, row), this->elements);
+
+	if (element.getTableIndex() < 0 || element.getTableIndex() >= static_cast<int>(this->elements.size()))
+	{
+		return nullptr;
+	}
+
+	return &this->elements[element.getTableIndex()];
+}
+
+//========================================================================================================================
+void DICOMViewer::generatePathToRoot(DcmWidgetElement element, int row, QList<DcmWidgetElement> *elements) const
 {
 	if (element.getDepth() == 0)
 	{
@@ -932,7 +1392,7 @@ void DICOMViewer::generatePathToRoot(DcmWidgetElement element, int row, QList<Dc
 }
 
 //========================================================================================================================
-bool DICOMViewer::shouldModify(DcmWidgetElement element)
+bool DICOMViewer::shouldModify(const DcmWidgetElement& element)
 {
 
 	bool contains = false;
@@ -952,7 +1412,7 @@ bool DICOMViewer::shouldModify(DcmWidgetElement element)
 }
 
 //========================================================================================================================
-int DICOMViewer::currentRow(DcmWidgetElement element, const int& finalRow) const
+int DICOMViewer::currentRow(const DcmWidgetElement& element, const int& finalRow) const
 {
 
 	int index = 0;
@@ -1036,20 +1496,18 @@ void DICOMViewer::deleteClicked()
 		{
 			list.removeLast();
 
-			if (deleteElementFromFile(sequence, element, list))
+			if (deleteElementFromFile(sequence, element, list, DcmEditJournal::Path()))
 			{
-				clearTable();
-				extractData(file);
+				this->refresh();
 			}
 		}
 	}
 
 	else
 	{
-		if (file.getDataset()->findAndDeleteElement(element.extractTagKey(), false, false).good())
+		if (this->journal.removeElement(DcmEditJournal::Path(), element.extractTagKey()).good())
 		{
-			clearTable();
-			extractData(file);
+			this->refresh();
 		}
 	}
 
@@ -1085,17 +1543,14 @@ void DICOMViewer::insertClicked()
 				{
 					if (list.size() == 1)
 					{
-						DcmItem* it = new DcmItem(DcmTag(insertElement.extractTagKey()));
-
-						if (!file.getDataset()->insertSequenceItem(sequence->getTag().getBaseTag(), it).good())
+						if (!this->journal.insertItem(DcmEditJournal::Path(), sequence->getTag().getBaseTag(), insertElement.extractTagKey()).good())
 						{
 							alertFailed("Failed!");
 						}
 
 						else
 						{
-							clearTable();
-							extractData(file);
+							this->refresh();
 							ui.tableWidget->scrollTo(this->scrollPosition, QAbstractItemView::PositionAtCenter);
 							ui.tableWidget->selectRow(this->scrollPosition.row());
 						}
@@ -1105,10 +1560,9 @@ void DICOMViewer::insertClicked()
 					{
 						list.removeLast();
 
-						if (this->insertElement(sequence, selectedElement, insertElement, list))
+						if (this->insertElement(sequence, selectedElement, insertElement, list, DcmEditJournal::Path()))
 						{
-							clearTable();
-							extractData(file);
+							this->refresh();
 							ui.tableWidget->scrollTo(this->scrollPosition, QAbstractItemView::PositionAtCenter);
 							ui.tableWidget->selectRow(this->scrollPosition.row());
 						}
@@ -1125,10 +1579,9 @@ void DICOMViewer::insertClicked()
 				{
 					list.removeLast();
 
-					if (this->insertElement(sequence, selectedElement, insertElement, list))
+					if (this->insertElement(sequence, selectedElement, insertElement, list, DcmEditJournal::Path()))
 					{
-						clearTable();
-						extractData(file);
+						this->refresh();
 						ui.tableWidget->scrollTo(this->scrollPosition, QAbstractItemView::PositionAtCenter);
 						ui.tableWidget->selectRow(this->scrollPosition.row());
 
@@ -1144,15 +1597,14 @@ void DICOMViewer::insertClicked()
 
 			else
 			{
-				if (!file.getDataset()->putAndInsertString(insertElement.extractTagKey(), insertElement.getItemValue().toStdString().c_str(), false).good())
+				if (!this->journal.insertString(DcmEditJournal::Path(), insertElement.extractTagKey(), insertElement.getItemValue().toStdString().c_str()).good())
 				{
 					alertFailed("Failed!");
 				}
 
 				else
 				{
-					clearTable();
-					extractData(file);
+					this->refresh();
 					this->findIndexInserted(insertElement);
 					ui.tableWidget->scrollTo(this->scrollPosition, QAbstractItemView::PositionAtCenter);
 					ui.tableWidget->selectRow(this->scrollPosition.row());
@@ -1164,24 +1616,22 @@ void DICOMViewer::insertClicked()
 		{
 			if (insertElement.getItemVR() == "SQ")
 			{
-				if (!file.getDataset()->insertEmptyElement(insertElement.extractTagKey(), false).good())
+				if (!this->journal.insertEmpty(DcmEditJournal::Path(), insertElement.extractTagKey()).good())
 				{
 					alertFailed("Failed!");
 				}
 				else
 				{
-					clearTable();
-					extractData(file);
+					this->refresh();
 				}
 			}
-			else if (!file.getDataset()->putAndInsertString(insertElement.extractTagKey(),insertElement.getItemValue().toStdString().c_str(),false).good())
+			else if (!this->journal.insertString(DcmEditJournal::Path(), insertElement.extractTagKey(), insertElement.getItemValue().toStdString().c_str()).good())
 			{
 				alertFailed("Failed!");
 			}
 			else
 			{
-				clearTable();
-				extractData(file);
+				this->refresh();
 				this->findIndexInserted(insertElement);
 				ui.tableWidget->scrollTo(this->scrollPosition, QAbstractItemView::PositionAtCenter);
 				ui.tableWidget->selectRow(this->scrollPosition.row());
@@ -7,6 +7,7 @@
 #include <QtWidgets/QMainWindow>
 #include <QtWidgets/qfiledialog.h>
 #include <QtWidgets/qmessagebox.h>
+#include <QtWidgets/qinputdialog.h>
 #include "ui_DICOMViewer.h"
 #include "dcmtk/dcmdata/dcfilefo.h"
 #include "dcmtk/dcmdata/dcmetinf.h"
@@ -16,6 +17,12 @@
 #include "EditDialogSimple.h"
 #include "TagSelectDialog.h"
 #include "CompareDialog.h"
+#include "BatchEditDialog.h"
+#include "DcmFastSave.h"
+#include "DcmEditJournal.h"
+#include "DcmStreamParser.h"
+#include "DcmOffsetIndex.h"
+#include "DcmDatasetStats.h"
 #include <dcmtk/dcmdata/dcpixseq.h>
 #include <dcmtk/dcmdata/dcpixel.h>
 #include <dcmtk/dcmdata/dcpxitem.h>
@@ -33,41 +40,74 @@ class DICOMViewer final : public QMainWindow
 	private:
 		Ui::DICOMViewerClass ui{};
 		DcmFileFormat file;
-		std::vector<DcmWidgetElement> elements;
-		std::vector<DcmWidgetElement> nestedElements;
+		DcmFastSave fastSave;
+		DcmEditJournal journal;
+		DcmOffsetIndex offsetIndex;
+		DcmDatasetStats statistics;
+		std::pmr::monotonic_buffer_resource arena{ 1 << 20 };
+		DcmElementList elements{ &arena };
+		DcmElementList nestedElements{ &arena };
 		unsigned long globalIndex = 0;
 		int depthRE = 0;
+		bool streamed = false;
+		QString currentFileName;
 		QModelIndex scrollPosition;
 		CompareDialog* dialog{};
+
+		// formatting and row insertion are summed here per row and reported once per phase
+		struct PhaseTotals
+		{
+			long long create = 0;
+			long long insert = 0;
+			long long created = 0;
+			long long inserted = 0;
+		};
+
+		mutable PhaseTotals phase;
 		void insertInTable(DcmElement* element);
-		void extractData(DcmFileFormat file);
-		void repopulate(std::vector<DcmWidgetElement> source) const;
+		void extractData(DcmFileFormat& file);
+		bool openStreaming(const QString& fileName);
+		void showStreamed(const QString& fileName);
+		void repopulate(const DcmElementList& source) const;
+		void repopulate(const std::vector<const DcmWidgetElement*>& source) const;
 		void getNestedSequences(const DcmTagKey& tag, DcmSequenceOfItems* sequence);
 		void iterateItem(DcmItem *item, int& depth);
+		static size_t countRows(DcmObject* object);
 		void clearTable();
+		void releaseElements();
+		void reportPhase(long long start) const;
 		static void alertFailed(const std::string& message);
 		static void indent(DcmWidgetElement& element, int depth);
 		DcmWidgetElement createElement(DcmElement* element = nullptr, DcmSequenceOfItems* sequence = nullptr, DcmItem* item = nullptr) const;
-		void insert(DcmWidgetElement element, unsigned long &index) const;
+		void insert(const DcmWidgetElement& element, unsigned long index) const;
 		static double getFileSize(const std::string& fileName);
 		void  getTagKeyOfSequence(int row, DcmTagKey* returnKey, int* numberInSequence) const;
-		static bool deleteElementFromFile(DcmSequenceOfItems* sequence, DcmWidgetElement element, QList<DcmWidgetElement> list);
-		static bool modifyValue(DcmSequenceOfItems* sequence, DcmWidgetElement element, QList<DcmWidgetElement> list,const QString& value);
-		bool insertElement(DcmSequenceOfItems* sequence, DcmWidgetElement element, DcmWidgetElement insertElement, QList<DcmWidgetElement> list) const;
-		void createSimpleEditDialog(DcmWidgetElement element);
-		void generatePathToRoot(DcmWidgetElement element, int row, QList<DcmWidgetElement> *elements);
-		static bool shouldModify(DcmWidgetElement element);
-		int currentRow(DcmWidgetElement element,const int& finalRow) const;
+		bool deleteElementFromFile(DcmSequenceOfItems* sequence, const DcmWidgetElement& element, QList<DcmWidgetElement>& list, DcmEditJournal::Path path);
+		bool modifyValue(DcmSequenceOfItems* sequence, const DcmWidgetElement& element, QList<DcmWidgetElement>& list, const QString& value, DcmEditJournal::Path path);
+		bool insertElement(DcmSequenceOfItems* sequence, const DcmWidgetElement& element, const DcmWidgetElement& insertElement, QList<DcmWidgetElement>& list, DcmEditJournal::Path path);
+		void createSimpleEditDialog(const DcmWidgetElement& selected);
+		void valueModified(int tableIndex, const QString& value);
+		void refresh();
+		void openHexInspector();
+		void goToOffset();
+		void locateElements();
+		const DcmWidgetElement* elementAtRow(int row) const;
+		void generatePathToRoot(DcmWidgetElement element, int row, QList<DcmWidgetElement> *elements) const;
+		static bool shouldModify(const DcmWidgetElement& element);
+		int currentRow(const DcmWidgetElement& element, const int& finalRow) const;
 		static void precision(std::string& nr, const int& precision);
 		void findIndexInserted(DcmWidgetElement& element);
 		friend void replace(std::string& str, const std::string& from, const std::string& to);
+		friend class DcmBenchmark;
 
 	private slots:
 		void fileTriggered(QAction* qaction);
+		void openFile(const QString& fileName);
 		void closeButtonClicked();
 		void editClicked();
 		void deleteClicked();
 		void insertClicked();
 		void findText();
 		void tableClicked(int row, int collumn);
+		void tableDoubleClicked(int row, int collumn);
 };
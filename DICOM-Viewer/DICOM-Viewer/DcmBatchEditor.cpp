@@ -0,0 +1,408 @@
+#include "DcmBatchEditor.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QRunnable>
+#include <QThread>
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcsequen.h"
+#include "dcmtk/dcmdata/dcuid.h"
+
+class DcmBatchTask final : public QRunnable
+{
+	public:
+		DcmBatchTask(DcmBatchEditor* editor, const QString& input, const QString& output) : editor(editor), input(input), output(output) { }
+
+		void run() override
+		{
+			this->editor->processFile(this->input, this->output);
+		}
+
+	private:
+		DcmBatchEditor* editor;
+		QString input;
+		QString output;
+};
+
+//========================================================================================================================
+DcmBatchEditor::DcmBatchEditor(QObject* parent) : QObject(parent)
+{
+}
+
+//========================================================================================================================
+DcmBatchEditor::~DcmBatchEditor()
+{
+	this->cancel();
+	this->pool.waitForDone();
+}
+
+//========================================================================================================================
+bool DcmBatchEditor::parseRules(const QString& text, std::vector<Rule>& rules, QString& error)
+{
+	const QRegularExpression tagExpression("^\\(([0-9A-Fa-f]{4}),([0-9A-Fa-f]{4})\\)$");
+	const QStringList lines = text.split('\n');
+	rules.clear();
+
+	for (int i = 0; i < lines.size(); i++)
+	{
+		const QString line = lines[i].trimmed();
+
+		if (line.isEmpty() || line.startsWith('#'))
+		{
+			continue;
+		}
+
+		const QStringList tokens = line.split(QRegularExpression("\\s+"));
+		const QString action = tokens[0].toLower();
+		Rule rule;
+
+		if (action == "uids")
+		{
+			rule.action = Action::ReplaceAllUids;
+			rules.push_back(rule);
+			continue;
+		}
+
+		if (action == "set")
+			rule.action = Action::Set;
+		else if (action == "remove")
+			rule.action = Action::Remove;
+		else if (action == "hash")
+			rule.action = Action::Hash;
+		else if (action == "uid")
+			rule.action = Action::ReplaceUid;
+		else
+		{
+			error = "Line " + QString::number(i + 1) + ": unknown action \"" + tokens[0] + "\"";
+			return false;
+		}
+
+		if (tokens.size() < 2)
+		{
+			error = "Line " + QString::number(i + 1) + ": missing tag";
+			return false;
+		}
+
+		const QRegularExpressionMatch match = tagExpression.match(tokens[1]);
+
+		if (match.hasMatch())
+		{
+			rule.tag = DcmTagKey(match.captured(1).toUShort(nullptr, 16), match.captured(2).toUShort(nullptr, 16));
+		}
+
+		else
+		{
+			DcmTag tag;
+
+			if (DcmTag::findTagFromName(tokens[1].toStdString().c_str(), tag).bad())
+			{
+				error = "Line " + QString::number(i + 1) + ": unknown tag \"" + tokens[1] + "\"";
+				return false;
+			}
+
+			rule.tag = tag.getBaseTag();
+		}
+
+		const DcmEVR vr = DcmTag(rule.tag).getEVR();
+
+		if (rule.action == Action::Hash && vr != EVR_UNKNOWN && vr != EVR_UN && vr != EVR_UI && !isHashable(vr))
+		{
+			error = "Line " + QString::number(i + 1) + ": " + tokens[1] + " has VR " + DcmVR(vr).getVRName() + ", which cannot hold a hash";
+			return false;
+		}
+
+		rule.value = line.section(QRegularExpression("\\s+"), 2).toStdString().c_str();
+		rules.push_back(rule);
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+void DcmBatchEditor::start(const QString& inputFolder, const QString& outputFolder, const std::vector<Rule>& rules, const int threads)
+{
+	this->rules = rules;
+	this->done = 0;
+	this->failed = 0;
+	this->cancelled = false;
+
+	{
+		std::lock_guard<std::mutex> lock(this->failureMutex);
+		this->failures.clear();
+	}
+
+	QStringList files;
+	QDirIterator iterator(inputFolder, QDir::Files, QDirIterator::Subdirectories);
+
+	while (iterator.hasNext())
+	{
+		files.append(iterator.next());
+	}
+
+	this->total = files.size();
+	this->pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+
+	if (files.empty())
+	{
+		emit finished();
+		return;
+	}
+
+	const QDir input(inputFolder);
+	const QDir output(outputFolder);
+
+	for (const auto& file : files)
+	{
+		this->pool.start(new DcmBatchTask(this, file, output.filePath(input.relativeFilePath(file))));
+	}
+}
+
+//========================================================================================================================
+void DcmBatchEditor::cancel()
+{
+	this->cancelled = true;
+}
+
+//========================================================================================================================
+bool DcmBatchEditor::isRunning() const
+{
+	return this->done < this->total;
+}
+
+//========================================================================================================================
+int DcmBatchEditor::failedCount() const
+{
+	return this->failed;
+}
+
+//========================================================================================================================
+QStringList DcmBatchEditor::getFailures() const
+{
+	std::lock_guard<std::mutex> lock(this->failureMutex);
+	return this->failures;
+}
+
+//========================================================================================================================
+void DcmBatchEditor::processFile(const QString& input, const QString& output)
+{
+	if (!this->cancelled)
+	{
+		DcmFileFormat file;
+		QString error;
+		OFCondition cond = file.loadFile(QFile::encodeName(input).constData());
+		bool ok = cond.good();
+
+		if (!ok)
+		{
+			error = QString("load failed: ") + cond.text();
+		}
+
+		else if (this->applyRules(file, error))
+		{
+			QDir().mkpath(QFileInfo(output).absolutePath());
+			cond = file.saveFile(QFile::encodeName(output).constData());
+			ok = cond.good();
+
+			if (!ok)
+			{
+				error = QString("save failed: ") + cond.text();
+			}
+		}
+
+		else
+		{
+			ok = false;
+		}
+
+		if (!ok)
+		{
+			this->failed++;
+			std::lock_guard<std::mutex> lock(this->failureMutex);
+			this->failures.append(input + ": " + error);
+		}
+	}
+
+	const int current = ++this->done;
+	emit progress(current, this->total);
+
+	if (current == this->total)
+	{
+		emit finished();
+	}
+}
+
+//========================================================================================================================
+bool DcmBatchEditor::applyRules(DcmFileFormat& file, QString& error)
+{
+	DcmDataset* dataSet = file.getDataset();
+
+	for (const auto& rule : this->rules)
+	{
+		if (rule.action == Action::Set)
+		{
+			const OFCondition cond = dataSet->putAndInsertString(rule.tag, rule.value.c_str(), OFTrue);
+
+			if (cond.bad())
+			{
+				error = QString("set ") + rule.tag.toString().c_str() + " failed: " + cond.text();
+				return false;
+			}
+		}
+
+		else if (rule.action == Action::Remove)
+		{
+			dataSet->findAndDeleteElement(rule.tag, OFTrue, OFTrue);
+		}
+
+		else if (!this->applyToItem(dataSet, rule, error))
+		{
+			return false;
+		}
+	}
+
+	OFString instanceUid;
+
+	if (dataSet->findAndGetOFString(DCM_SOPInstanceUID, instanceUid).good())
+	{
+		file.getMetaInfo()->putAndInsertString(DCM_MediaStorageSOPInstanceUID, instanceUid.c_str());
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+bool DcmBatchEditor::applyToItem(DcmItem* item, const Rule& rule, QString& error)
+{
+	for (unsigned long i = 0; i < item->card(); i++)
+	{
+		DcmElement* element = item->getElement(i);
+		const DcmTagKey tag = element->getTag().getBaseTag();
+
+		if (element->ident() == EVR_SQ)
+		{
+			auto* sequence = OFstatic_cast(DcmSequenceOfItems*, element);
+
+			for (unsigned long j = 0; j < sequence->card(); j++)
+			{
+				if (!this->applyToItem(sequence->getItem(j), rule, error))
+				{
+					return false;
+				}
+			}
+
+			continue;
+		}
+
+		const bool uid = element->ident() == EVR_UI;
+		const bool matches = rule.action == Action::ReplaceAllUids ? uid && !isClassUid(tag) : tag == rule.tag;
+
+		if (!matches)
+		{
+			continue;
+		}
+
+		if (rule.action == Action::Hash && !uid && !isHashable(element->ident()))
+		{
+			error = QString("cannot hash ") + tag.toString().c_str() + " with VR " + DcmVR(element->ident()).getVRName();
+			return false;
+		}
+
+		OFString value;
+		element->getOFStringArray(value);
+		OFCondition cond = EC_Normal;
+
+		if (rule.action == Action::Hash && !uid)
+		{
+			cond = element->putString(hashValue(value, rule.value, element->ident()).c_str());
+		}
+
+		else if (uid)
+		{
+			cond = element->putString(this->remapUid(value).c_str());
+		}
+
+		if (cond.bad())
+		{
+			error = QString("writing ") + tag.toString().c_str() + " failed: " + cond.text();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+OFString DcmBatchEditor::remapUid(const OFString& uid)
+{
+	const QStringList values = QString(uid.c_str()).split('\\');
+	QStringList result;
+	std::lock_guard<std::mutex> lock(this->uidMutex);
+
+	for (const auto& value : values)
+	{
+		const std::string key = value.trimmed().toStdString();
+
+		if (key.empty() || key.compare(0, 14, "1.2.840.10008.") == 0)
+		{
+			result.append(QString::fromStdString(key));
+			continue;
+		}
+
+		auto found = this->uidMap.find(key);
+
+		if (found == this->uidMap.end())
+		{
+			char buffer[100];
+			dcmGenerateUniqueIdentifier(buffer, SITE_INSTANCE_UID_ROOT);
+			found = this->uidMap.emplace(key, buffer).first;
+		}
+
+		result.append(QString::fromStdString(found->second));
+	}
+
+	return result.join('\\').toStdString().c_str();
+}
+
+//========================================================================================================================
+OFString DcmBatchEditor::hashValue(const OFString& value, const OFString& salt, const DcmEVR vr)
+{
+	const QByteArray digest = QCryptographicHash::hash(QByteArray(salt.c_str()) + QByteArray(value.c_str()), QCryptographicHash::Sha256);
+
+	// dates and times are derived from the digest so they stay valid for their VR
+	if (vr == EVR_DA || vr == EVR_TM || vr == EVR_DT)
+	{
+		const Uint32 seed = OFstatic_cast(Uint8, digest[0]) | OFstatic_cast(Uint32, OFstatic_cast(Uint8, digest[1])) << 8
+			| OFstatic_cast(Uint32, OFstatic_cast(Uint8, digest[2])) << 16 | OFstatic_cast(Uint32, OFstatic_cast(Uint8, digest[3])) << 24;
+		const QString date = QString("%1%2%3").arg(1900 + seed % 100, 4, 10, QChar('0')).arg(1 + seed / 100 % 12, 2, 10, QChar('0')).arg(1 + seed / 1200 % 28, 2, 10, QChar('0'));
+		const Uint32 seconds = OFstatic_cast(Uint8, digest[4]) | OFstatic_cast(Uint32, OFstatic_cast(Uint8, digest[5])) << 8 | OFstatic_cast(Uint32, OFstatic_cast(Uint8, digest[6])) << 16;
+		const QString time = QString("%1%2%3").arg(seconds % 86400 / 3600, 2, 10, QChar('0')).arg(seconds % 3600 / 60, 2, 10, QChar('0')).arg(seconds % 60, 2, 10, QChar('0'));
+
+		return (vr == EVR_DA ? date : vr == EVR_TM ? time : date + time).toStdString().c_str();
+	}
+
+	const int length = vr == EVR_SH || vr == EVR_CS || vr == EVR_AE ? 16 : 32;
+	return digest.toHex().toUpper().left(length).constData();
+}
+
+//========================================================================================================================
+bool DcmBatchEditor::isHashable(const DcmEVR vr)
+{
+	switch (vr)
+	{
+		case EVR_AE: case EVR_CS: case EVR_SH: case EVR_LO: case EVR_PN: case EVR_LT: case EVR_ST: case EVR_UT:
+		case EVR_DA: case EVR_TM: case EVR_DT:
+			return true;
+		default:
+			return false;
+	}
+}
+
+//========================================================================================================================
+bool DcmBatchEditor::isClassUid(const DcmTagKey& tag)
+{
+	return tag == DCM_SOPClassUID || tag == DCM_ReferencedSOPClassUID || tag == DCM_MediaStorageSOPClassUID ||
+		tag == DCM_TransferSyntaxUID || tag == DCM_ImplementationClassUID || tag == DCM_ReferencedSOPClassUIDInFile ||
+		tag == DCM_ReferencedTransferSyntaxUIDInFile || tag == DCM_CodingSchemeUID;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dctagkey.h"
+
+class DcmBatchEditor final : public QObject
+{
+	Q_OBJECT
+
+	public:
+		enum class Action
+		{
+			Set,
+			Remove,
+			Hash,
+			ReplaceUid,
+			ReplaceAllUids
+		};
+
+		struct Rule
+		{
+			Action action = Action::Set;
+			DcmTagKey tag;
+			OFString value;
+		};
+
+		explicit DcmBatchEditor(QObject* parent = nullptr);
+		~DcmBatchEditor();
+
+		static bool parseRules(const QString& text, std::vector<Rule>& rules, QString& error);
+		void start(const QString& inputFolder, const QString& outputFolder, const std::vector<Rule>& rules, int threads);
+		void cancel();
+		bool isRunning() const;
+		int failedCount() const;
+		QStringList getFailures() const;
+		void processFile(const QString& input, const QString& output);
+
+	signals:
+		void progress(int done, int total);
+		void finished();
+
+	private:
+		QThreadPool pool;
+		std::vector<Rule> rules;
+		std::mutex uidMutex;
+		std::unordered_map<std::string, std::string> uidMap;
+		std::atomic<int> done{ 0 };
+		std::atomic<int> failed{ 0 };
+		std::atomic<bool> cancelled{ false };
+		mutable std::mutex failureMutex;
+		QStringList failures;
+		int total = 0;
+
+		bool applyRules(DcmFileFormat& file, QString& error);
+		bool applyToItem(DcmItem* item, const Rule& rule, QString& error);
+		OFString remapUid(const OFString& uid);
+		static OFString hashValue(const OFString& value, const OFString& salt, DcmEVR vr);
+		static bool isHashable(DcmEVR vr);
+		static bool isClassUid(const DcmTagKey& tag);
+};
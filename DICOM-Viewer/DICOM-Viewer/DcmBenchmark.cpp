@@ -0,0 +1,291 @@
+#include "DcmBenchmark.h"
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include "CompareDialog.h"
+#include "DICOMViewer.h"
+#include "DcmThreeWayMerge.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+#define BENCHMARK_FLAG "--benchmark"
+
+DcmBenchmark::DcmBenchmark(const Options& options) : options(options)
+{
+}
+
+//========================================================================================================================
+bool DcmBenchmark::isRequested(const QStringList& arguments)
+{
+	return arguments.contains(BENCHMARK_FLAG);
+}
+
+//========================================================================================================================
+bool DcmBenchmark::parseArguments(const QStringList& arguments, Options& options)
+{
+	QCommandLineParser parser;
+	parser.addOption(QCommandLineOption("benchmark"));
+	parser.addOption(QCommandLineOption("elements", "Elements per file.", "count", "1000"));
+	parser.addOption(QCommandLineOption("depth", "Nested sequence depth.", "count", "4"));
+	parser.addOption(QCommandLineOption("items", "Items per sequence.", "count", "3"));
+	parser.addOption(QCommandLineOption("frames", "Number of frames.", "count", "1"));
+	parser.addOption(QCommandLineOption("rows", "Rows per frame.", "count", "256"));
+	parser.addOption(QCommandLineOption("columns", "Columns per frame.", "count", "256"));
+	parser.addOption(QCommandLineOption("iterations", "Repetitions of every phase.", "count", "3"));
+	parser.addOption(QCommandLineOption("output", "JSON lines output file.", "file"));
+	parser.addOption(QCommandLineOption("label", "Free text stored with every record, e.g. a commit id.", "text"));
+
+	if (!parser.parse(arguments))
+	{
+		std::cerr << parser.errorText().toStdString() << std::endl;
+		return false;
+	}
+
+	options.corpus.elements = parser.value("elements").toULong();
+	options.corpus.sequenceDepth = parser.value("depth").toInt();
+	options.corpus.itemsPerSequence = parser.value("items").toInt();
+	options.corpus.frames = parser.value("frames").toInt();
+	options.corpus.rows = parser.value("rows").toUShort();
+	options.corpus.columns = parser.value("columns").toUShort();
+	options.iterations = std::max(1, parser.value("iterations").toInt());
+	options.output = parser.value("output");
+	options.label = parser.value("label");
+	return true;
+}
+
+//========================================================================================================================
+int DcmBenchmark::run(const QStringList& arguments)
+{
+	Options options;
+
+	if (!parseArguments(arguments, options))
+	{
+		return 1;
+	}
+
+	DcmBenchmark benchmark(options);
+	const QTemporaryDir folder;
+
+	if (!folder.isValid())
+	{
+		std::cerr << "Cannot create temporary folder" << std::endl;
+		return 1;
+	}
+
+	if (!options.output.isEmpty())
+	{
+		benchmark.file.open(QFile::encodeName(options.output).toStdString(), std::ios::out | std::ios::app);
+
+		if (!benchmark.file)
+		{
+			std::cerr << "Cannot open " << options.output.toStdString() << std::endl;
+			return 1;
+		}
+	}
+
+	for (int i = 0; i < options.iterations; i++)
+	{
+		if (!benchmark.runIteration(folder.path(), i))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+//========================================================================================================================
+long long DcmBenchmark::peakResidentKb()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return OFstatic_cast(long long, counters.PeakWorkingSetSize / 1024);
+	}
+
+	return 0;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+//========================================================================================================================
+void DcmBenchmark::report(const char* name, const int iteration, const double milliseconds, const unsigned long long bytes, const unsigned long long rows)
+{
+	const double seconds = milliseconds / 1000.0;
+	std::ostringstream line;
+
+	line << "{\"label\":\"" << this->options.label.toStdString() << "\",\"phase\":\"" << name << "\",\"iteration\":" << iteration
+		<< ",\"elements\":" << this->options.corpus.elements << ",\"depth\":" << this->options.corpus.sequenceDepth
+		<< ",\"frames\":" << this->options.corpus.frames << ",\"rows\":" << this->options.corpus.rows << ",\"columns\":" << this->options.corpus.columns
+		<< ",\"ms\":" << milliseconds << ",\"bytes\":" << bytes << ",\"tableRows\":" << rows
+		<< ",\"mbPerSecond\":" << (seconds > 0 ? bytes / 1048576.0 / seconds : 0)
+		<< ",\"rowsPerSecond\":" << (seconds > 0 ? rows / seconds : 0)
+		<< ",\"peakRssKb\":" << peakResidentKb() << "}";
+
+	std::cout << line.str() << std::endl;
+
+	if (this->file.is_open())
+	{
+		this->file << line.str() << std::endl;
+	}
+}
+
+//========================================================================================================================
+bool DcmBenchmark::sameDataset(DcmDataset* expected, DcmDataset* actual, std::string& difference)
+{
+	if (expected->card() != actual->card())
+	{
+		difference = "element count " + std::to_string(actual->card()) + " instead of " + std::to_string(expected->card());
+		return false;
+	}
+
+	DcmObject* first = nullptr;
+	DcmObject* second = nullptr;
+
+	// both are sorted by tag, so elements pair up in order
+	for (unsigned long i = 0; i < expected->card(); i++)
+	{
+		first = expected->nextInContainer(first);
+		second = actual->nextInContainer(second);
+
+		if (first->getTag() != second->getTag() || !DcmThreeWayMerge::same(OFstatic_cast(DcmElement*, first), OFstatic_cast(DcmElement*, second)))
+		{
+			difference = "element " + std::string(first->getTag().toString().c_str()) + " differs";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+bool DcmBenchmark::runIteration(const QString& folder, const int iteration)
+{
+	using Clock = std::chrono::steady_clock;
+	const auto elapsed = [](const Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); };
+
+	const std::string first = QFile::encodeName(folder + "/first.dcm").toStdString();
+	const std::string second = QFile::encodeName(folder + "/second.dcm").toStdString();
+	const std::string saved = QFile::encodeName(folder + "/saved.dcm").toStdString();
+	const std::string fastSaved = QFile::encodeName(folder + "/fastsaved.dcm").toStdString();
+	DcmCorpusGenerator::Options corpus = this->options.corpus;
+
+	auto start = Clock::now();
+	corpus.seed = 1;
+	OFCondition status = DcmCorpusGenerator::generate(first, corpus);
+	corpus.seed = 2;
+
+	if (status.good())
+	{
+		status = DcmCorpusGenerator::generate(second, corpus);
+	}
+
+	if (status.bad())
+	{
+		std::cerr << "Failed to generate corpus: " << status.text() << std::endl;
+		return false;
+	}
+
+	const unsigned long long size = QFileInfo(QString::fromStdString(first)).size();
+	this->report("generate", iteration, elapsed(start), 2 * size, 0);
+
+	DICOMViewer viewer;
+	start = Clock::now();
+
+	if (viewer.file.loadFile(first.c_str()).bad())
+	{
+		std::cerr << "Failed to load " << first << std::endl;
+		return false;
+	}
+
+	this->report("load", iteration, elapsed(start), size, 0);
+
+	start = Clock::now();
+	viewer.extractData(viewer.file);
+	const unsigned long long rows = viewer.elements.size();
+	this->report("extractData", iteration, elapsed(start), size, rows);
+
+	start = Clock::now();
+	viewer.ui.lineEdit->setText("LEVEL 1");
+	viewer.findText();
+	viewer.ui.lineEdit->clear();
+	viewer.findText();
+	this->report("findText", iteration, elapsed(start), 0, 2 * rows);
+
+	// the ranges come from the offset index like in openFile, so fast save does not rescan the source
+	start = Clock::now();
+
+	if (!viewer.offsetIndex.build(first))
+	{
+		std::cerr << "Failed to index " << first << std::endl;
+		return false;
+	}
+
+	std::map<DcmTagKey, DcmFastSave::Range> ranges;
+	viewer.offsetIndex.getTopLevelRanges(ranges);
+	viewer.fastSave.setSource(&viewer.file, first);
+	viewer.fastSave.setRanges(ranges, viewer.offsetIndex.getDatasetOffset());
+	this->report("offsetIndex", iteration, elapsed(start), viewer.offsetIndex.getBytesRead(), 0);
+
+	viewer.file.getDataset()->putAndInsertString(DCM_PatientName, "BENCHMARK^SAVED");
+	viewer.fastSave.markDirty(DCM_PatientName);
+	start = Clock::now();
+	status = viewer.fastSave.saveFile(fastSaved);
+	this->report("fastSave", iteration, elapsed(start), size, 0);
+
+	DcmFileFormat fastReloaded;
+	std::string difference;
+
+	if (status.bad() || fastReloaded.loadFile(fastSaved.c_str()).bad() || !sameDataset(viewer.file.getDataset(), fastReloaded.getDataset(), difference))
+	{
+		std::cerr << "Fast save round trip failed: " << (status.bad() ? status.text() : difference.empty() ? "cannot reload" : difference.c_str()) << std::endl;
+		return false;
+	}
+
+	start = Clock::now();
+	status = status.good() ? viewer.file.saveFile(saved.c_str()) : status;
+	this->report("save", iteration, elapsed(start), size, 0);
+
+	DcmFileFormat reloaded;
+	start = Clock::now();
+	status = status.good() ? reloaded.loadFile(saved.c_str()) : status;
+	this->report("reload", iteration, elapsed(start), size, 0);
+
+	if (status.bad())
+	{
+		std::cerr << "Save round trip failed: " << status.text() << std::endl;
+		return false;
+	}
+
+	auto* dialog = new CompareDialog(nullptr);
+	dialog->loadFile(&dialog->file1, QString::fromStdString(first), true);
+	dialog->loadFile(&dialog->file2, QString::fromStdString(second), false);
+
+	start = Clock::now();
+	dialog->merge();
+	this->report("merge", iteration, elapsed(start), 2 * size, dialog->model->rowCount());
+
+	delete dialog;
+	return true;
+}
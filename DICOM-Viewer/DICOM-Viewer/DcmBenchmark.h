@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <fstream>
+#include "DcmCorpusGenerator.h"
+#include "dcmtk/dcmdata/dcdatset.h"
+
+class DcmBenchmark
+{
+	public:
+		struct Options
+		{
+			DcmCorpusGenerator::Options corpus;
+			int iterations = 3;
+			QString output;
+			QString label;
+		};
+
+		static bool isRequested(const QStringList& arguments);
+		static int run(const QStringList& arguments);
+
+	private:
+		explicit DcmBenchmark(const Options& options);
+
+		Options options;
+		std::ofstream file;
+
+		static bool parseArguments(const QStringList& arguments, Options& options);
+		static long long peakResidentKb();
+		static bool sameDataset(DcmDataset* expected, DcmDataset* actual, std::string& difference);
+		void report(const char* name, int iteration, double milliseconds, unsigned long long bytes, unsigned long long rows);
+		bool runIteration(const QString& folder, int iteration);
+};
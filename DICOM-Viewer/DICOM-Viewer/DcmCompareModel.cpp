@@ -0,0 +1,277 @@
+#include "DcmCompareModel.h"
+#include <QColor>
+#include <QFont>
+#include <algorithm>
+#include <iterator>
+
+DcmCompareModel::DcmCompareModel(QObject* parent) : QAbstractTableModel(parent)
+{
+}
+
+//========================================================================================================================
+void DcmCompareModel::setRows(std::vector<Row>&& rows)
+{
+	this->beginResetModel();
+	this->rows = std::move(rows);
+	this->next.clear();
+	this->previous.assign(1, -1);
+	this->relevant.clear();
+	this->open.clear();
+	this->unresolved = 0;
+	this->differences = 0;
+	this->indexRows(0);
+	this->endResetModel();
+}
+
+//========================================================================================================================
+void DcmCompareModel::appendRows(std::vector<Row>&& rows)
+{
+	if (rows.empty())
+	{
+		return;
+	}
+
+	const int first = static_cast<int>(this->rows.size());
+	this->beginInsertRows(QModelIndex(), first, first + static_cast<int>(rows.size()) - 1);
+	this->rows.insert(this->rows.end(), std::make_move_iterator(rows.begin()), std::make_move_iterator(rows.end()));
+	const int touched = this->indexRows(first);
+	this->endInsertRows();
+
+	// enclosing rows that just became relevant have to be filtered again
+	if (touched < first)
+	{
+		emit dataChanged(this->index(touched, 0), this->index(first - 1, 4), { KindRole });
+	}
+}
+
+//========================================================================================================================
+void DcmCompareModel::clear()
+{
+	this->setRows(std::vector<Row>());
+}
+
+//========================================================================================================================
+const DcmCompareModel::Row& DcmCompareModel::getRow(const int row) const
+{
+	return this->rows[row];
+}
+
+//========================================================================================================================
+const std::vector<DcmCompareModel::Row>& DcmCompareModel::getRows() const
+{
+	return this->rows;
+}
+
+//========================================================================================================================
+int DcmCompareModel::indexRows(const int from)
+{
+	const int count = static_cast<int>(this->rows.size());
+	int touched = from;
+	this->next.resize(count + 1, -1);
+	this->previous.resize(count + 1, -1);
+	this->relevant.resize(count, 0);
+
+	// a row stays visible in differences only mode when it differs or one of its descendants does
+	for (int i = from; i < count; i++)
+	{
+		const Row& row = this->rows[i];
+		const DcmWidgetElement& element = row.kind == Added ? row.right : row.left;
+		const int depth = std::max(element.getDepth(), 0);
+		int closed = -1;
+
+		while (!this->open.empty() && this->open.back().first >= depth)
+		{
+			closed = this->open.back().first == depth ? this->open.back().second : closed;
+			this->open.pop_back();
+		}
+
+		if (row.kind != Equal)
+		{
+			this->differences++;
+			this->relevant[i] = 1;
+
+			for (auto parent = this->open.rbegin(); parent != this->open.rend() && !this->relevant[parent->second]; ++parent)
+			{
+				this->relevant[parent->second] = 1;
+				touched = std::min(touched, parent->second);
+			}
+
+			// rows after the previous difference now know where the next one is
+			std::fill(this->next.begin() + this->unresolved, this->next.begin() + i + 1, i);
+			this->unresolved = i + 1;
+		}
+
+		if (element.getItemDescription() == "ItemDelimitationItem" || element.getItemDescription() == "SequenceDelimitationItem")
+		{
+			this->relevant[i] |= closed >= 0 && this->relevant[closed];
+		}
+
+		else if (element.getItemVR() == "SQ" || element.getItemDescription() == "Item")
+		{
+			this->open.emplace_back(depth, i);
+		}
+
+		this->previous[i + 1] = row.kind != Equal ? i : this->previous[i];
+	}
+
+	return touched;
+}
+
+//========================================================================================================================
+int DcmCompareModel::nextDifference(const int row) const
+{
+	const int from = std::max(row + 1, 0);
+	return from < static_cast<int>(this->next.size()) ? this->next[from] : -1;
+}
+
+//========================================================================================================================
+int DcmCompareModel::previousDifference(const int row) const
+{
+	const int count = static_cast<int>(this->rows.size());
+	return this->previous[row < 0 || row > count ? count : row];
+}
+
+//========================================================================================================================
+int DcmCompareModel::getDifferenceCount() const
+{
+	return this->differences;
+}
+
+//========================================================================================================================
+bool DcmCompareModel::isRelevant(const int row) const
+{
+	return this->relevant[row] != 0;
+}
+
+//========================================================================================================================
+int DcmCompareModel::rowCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : static_cast<int>(this->rows.size());
+}
+
+//========================================================================================================================
+int DcmCompareModel::columnCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : 5;
+}
+
+//========================================================================================================================
+QVariant DcmCompareModel::data(const QModelIndex& index, const int role) const
+{
+	if (!index.isValid() || index.row() >= static_cast<int>(this->rows.size()))
+	{
+		return QVariant();
+	}
+
+	const Row& row = this->rows[index.row()];
+	const int column = index.column();
+
+	switch (role)
+	{
+		case Qt::DisplayRole:
+			switch (column)
+			{
+				case 0: return row.left.getItemTag();
+				case 1: return row.left.getItemLength();
+				case 2: return row.left.getItemValue();
+				case 3: return row.right.getItemLength();
+				default: return row.right.getItemValue();
+			}
+
+		case Qt::BackgroundRole:
+			if (column == 0)
+			{
+				return QColor(220, 220, 220);
+			}
+
+			if (row.kind == Changed)
+			{
+				return QColor(250, 128, 114);
+			}
+
+			if (row.kind == Added && column >= 3)
+			{
+				return QColor(104, 223, 240);
+			}
+
+			if (row.kind == Removed && column <= 2)
+			{
+				return QColor(0, 250, 154);
+			}
+
+			return QVariant();
+
+		case KindRole:
+			return static_cast<int>(row.kind);
+
+		default:
+			return QVariant();
+	}
+}
+
+//========================================================================================================================
+QVariant DcmCompareModel::headerData(const int section, const Qt::Orientation orientation, const int role) const
+{
+	if (orientation == Qt::Vertical)
+	{
+		return role == Qt::DisplayRole ? QVariant(section + 1) : QVariant();
+	}
+
+	if (role == Qt::FontRole)
+	{
+		QFont font;
+		font.setBold(true);
+		return font;
+	}
+
+	if (role == Qt::DisplayRole)
+	{
+		switch (section)
+		{
+			case 0: return QStringLiteral("Tag ID");
+			case 1: case 3: return QStringLiteral("Length");
+			default: return QStringLiteral("Value");
+		}
+	}
+
+	return QVariant();
+}
+
+//========================================================================================================================
+DcmCompareFilter::DcmCompareFilter(QObject* parent) : QSortFilterProxyModel(parent)
+{
+}
+
+//========================================================================================================================
+void DcmCompareFilter::setText(const QString& text)
+{
+	this->text = text;
+	this->invalidateFilter();
+}
+
+//========================================================================================================================
+void DcmCompareFilter::setDifferencesOnly(const bool differencesOnly)
+{
+	this->differencesOnly = differencesOnly;
+	this->invalidateFilter();
+}
+
+//========================================================================================================================
+bool DcmCompareFilter::filterAcceptsRow(const int sourceRow, const QModelIndex& sourceParent) const
+{
+	const auto* model = static_cast<const DcmCompareModel*>(this->sourceModel());
+
+	if (this->differencesOnly && !model->isRelevant(sourceRow))
+	{
+		return false;
+	}
+
+	if (this->text.isEmpty())
+	{
+		return true;
+	}
+
+	const DcmCompareModel::Row& row = model->getRow(sourceRow);
+
+	return row.left.checkIfContains(this->text) || row.right.checkIfContains(this->text);
+}
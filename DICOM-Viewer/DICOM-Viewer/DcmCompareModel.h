@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QSortFilterProxyModel>
+#include <vector>
+#include "DcmWidgetElement.h"
+
+class DcmCompareModel final : public QAbstractTableModel
+{
+	Q_OBJECT
+
+	public:
+		enum Kind { Equal, Changed, Added, Removed };
+		enum Role { KindRole = Qt::UserRole };
+
+		struct Row
+		{
+			DcmWidgetElement left;
+			DcmWidgetElement right;
+			Kind kind;
+		};
+
+		explicit DcmCompareModel(QObject* parent = nullptr);
+		void setRows(std::vector<Row>&& rows);
+		void appendRows(std::vector<Row>&& rows);
+		void clear();
+		const Row& getRow(int row) const;
+		const std::vector<Row>& getRows() const;
+		int nextDifference(int row) const;
+		int previousDifference(int row) const;
+		int getDifferenceCount() const;
+		bool isRelevant(int row) const;
+		int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+		int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+		QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+		QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+	private:
+		std::vector<Row> rows;
+		std::vector<int> next;
+		std::vector<int> previous;
+		std::vector<char> relevant;
+		std::vector<std::pair<int, int>> open;
+		int unresolved = 0;
+		int differences = 0;
+		int indexRows(int from);
+};
+
+class DcmCompareFilter final : public QSortFilterProxyModel
+{
+	Q_OBJECT
+
+	public:
+		explicit DcmCompareFilter(QObject* parent = nullptr);
+		void setText(const QString& text);
+		void setDifferencesOnly(bool differencesOnly);
+
+	protected:
+		bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+	private:
+		QString text;
+		bool differencesOnly = false;
+};
@@ -0,0 +1,355 @@
+#include "DcmComparePolicy.h"
+#include "DcmThreeWayMerge.h"
+#include <QRegularExpression>
+#include <cmath>
+#include "dcmtk/dcmdata/dcelem.h"
+#include "dcmtk/dcmdata/dctag.h"
+
+bool DcmComparePolicy::setOptions(const Options& options, QString& error)
+{
+	const QRegularExpression tagExpression("^\\(([0-9A-Fa-f]{4}),([0-9A-Fa-f]{4}|[Xx]{4})\\)$");
+	QSet<Uint32> tags;
+	QSet<Uint16> groups;
+
+	for (const auto& token : options.ignore.split(QRegularExpression("[\\s;]+"), QString::SkipEmptyParts))
+	{
+		const QRegularExpressionMatch match = tagExpression.match(token);
+
+		if (match.hasMatch())
+		{
+			const Uint16 group = match.captured(1).toUShort(nullptr, 16);
+
+			if (match.captured(2).compare("xxxx", Qt::CaseInsensitive) == 0)
+			{
+				groups.insert(group);
+			}
+
+			else
+			{
+				tags.insert(DcmTagKey(group, match.captured(2).toUShort(nullptr, 16)).hash());
+			}
+
+			continue;
+		}
+
+		DcmTag tag;
+
+		if (DcmTag::findTagFromName(token.toStdString().c_str(), tag).bad())
+		{
+			error = "Unknown tag \"" + token + "\"";
+			return false;
+		}
+
+		tags.insert(tag.getBaseTag().hash());
+	}
+
+	this->options = options;
+	this->tags = tags;
+	this->groups = groups;
+	this->reset();
+	return true;
+}
+
+//========================================================================================================================
+const DcmComparePolicy::Options& DcmComparePolicy::getOptions() const
+{
+	return this->options;
+}
+
+//========================================================================================================================
+void DcmComparePolicy::reset()
+{
+	this->forward.clear();
+	this->backward.clear();
+	this->conflictsFirst.clear();
+	this->conflictsSecond.clear();
+}
+
+//========================================================================================================================
+void DcmComparePolicy::learnUids(const std::vector<DcmWidgetElement>& first, const std::vector<DcmWidgetElement>& second)
+{
+	this->reset();
+
+	if (!this->options.uids)
+	{
+		return;
+	}
+
+	std::map<QString, QStringList> uids1;
+	std::map<QString, QStringList> uids2;
+	collectUids(first, uids1);
+	collectUids(second, uids2);
+
+	// the whole mapping is known before any row is judged, so the verdict does not depend on the traversal order
+	for (const auto& entry : uids1)
+	{
+		const auto other = uids2.find(entry.first);
+
+		if (other == uids2.end())
+		{
+			continue;
+		}
+
+		for (int i = 0; i < entry.second.size() && i < other->second.size(); i++)
+		{
+			const QString& uid1 = entry.second[i];
+			const QString& uid2 = other->second[i];
+			const auto mapped = this->forward.constFind(uid1);
+			const auto reverse = this->backward.constFind(uid2);
+
+			if (mapped != this->forward.constEnd() && *mapped != uid2)
+			{
+				this->conflictsFirst.insert(uid1);
+			}
+
+			if (reverse != this->backward.constEnd() && *reverse != uid1)
+			{
+				this->conflictsSecond.insert(uid2);
+			}
+
+			this->forward.insert(uid1, uid2);
+			this->backward.insert(uid2, uid1);
+		}
+	}
+}
+
+//========================================================================================================================
+bool DcmComparePolicy::isActive() const
+{
+	return !this->tags.isEmpty() || !this->groups.isEmpty() || this->options.tolerance >= 0 || this->options.uids || this->options.padding;
+}
+
+//========================================================================================================================
+bool DcmComparePolicy::ignores(const DcmWidgetElement& element) const
+{
+	if (this->tags.isEmpty() && this->groups.isEmpty())
+	{
+		return false;
+	}
+
+	const DcmTagKey tag = element.extractTagKey();
+	return this->tags.contains(tag.hash()) || this->groups.contains(tag.getGroup());
+}
+
+//========================================================================================================================
+bool DcmComparePolicy::equal(const DcmWidgetElement& first, const DcmWidgetElement& second)
+{
+	const QString vr = first.getItemVR();
+	const bool comparable = this->isActive() && vr == second.getItemVR() && first.getItemTag().trimmed() == second.getItemTag().trimmed();
+
+	// unchanged UIDs are mapped too, so a UID kept in one place cannot be replaced in another
+	if (comparable && this->options.uids && vr == "UI")
+	{
+		return first.getItemVM() == second.getItemVM() && this->uidEqual(first, second);
+	}
+
+	// the row text is a display preview, equality is decided on the full element values
+	if (first.getItemTag().trimmed() == second.getItemTag().trimmed() && first.getItemVM() == second.getItemVM() && vr == second.getItemVR()
+		&& first.getItemLength() == second.getItemLength() && sameValue(first, second))
+	{
+		return true;
+	}
+
+	if (!comparable)
+	{
+		return false;
+	}
+
+	// lengths are left out from here on, padding and number formatting change them
+	if (this->options.tolerance >= 0 && (vr == "DS" || vr == "FD" || vr == "FL" || vr == "OD" || vr == "OF"))
+	{
+		return this->numericEqual(first, second);
+	}
+
+	return this->options.padding && first.getItemVM() == second.getItemVM() && sameValue(first, second);
+}
+
+//========================================================================================================================
+bool DcmComparePolicy::sameValue(const DcmWidgetElement& first, const DcmWidgetElement& second)
+{
+	DcmElement* source1 = first.getSource();
+	DcmElement* source2 = second.getSource();
+
+	if (!source1 || !source2)
+	{
+		return first.getItemValue() == second.getItemValue();
+	}
+
+	const DcmEVR vr = source1->ident();
+
+	// binary values are compared as raw bytes, encapsulated pixel data fragment by fragment
+	if (vr == EVR_OB || vr == EVR_OW || vr == EVR_UN || vr == EVR_ox || vr == EVR_PixelData)
+	{
+		return DcmThreeWayMerge::same(source1, source2);
+	}
+
+	// strings are read without their padding
+	OFString value1;
+	OFString value2;
+	source1->getOFStringArray(value1);
+	source2->getOFStringArray(value2);
+	return value1 == value2;
+}
+
+//========================================================================================================================
+bool DcmComparePolicy::numbers(const DcmWidgetElement& element, std::vector<double>& values)
+{
+	DcmElement* source = element.getSource();
+
+	if (!source)
+	{
+		return false;
+	}
+
+	const DcmEVR vr = source->ident();
+	const bool single = vr == EVR_FL || vr == EVR_OF;
+	const unsigned long count = single ? source->getLength() / sizeof(Float32) : vr == EVR_FD || vr == EVR_OD ? source->getLength() / sizeof(Float64) : source->getVM();
+	values.resize(count);
+
+	for (unsigned long i = 0; i < count; i++)
+	{
+		Float32 value32 = 0;
+		Float64 value64 = 0;
+
+		if (single ? source->getFloat32(value32, i).bad() : source->getFloat64(value64, i).bad())
+		{
+			return false;
+		}
+
+		values[i] = single ? value32 : value64;
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+bool DcmComparePolicy::numericEqual(const DcmWidgetElement& first, const DcmWidgetElement& second) const
+{
+	std::vector<double> numbers1;
+	std::vector<double> numbers2;
+
+	// numbers come from the full values, the preview stops after a few of them
+	if (numbers(first, numbers1) && numbers(second, numbers2))
+	{
+		if (numbers1.size() != numbers2.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < numbers1.size(); i++)
+		{
+			if (std::fabs(numbers1[i] - numbers2[i]) > this->options.tolerance)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	if (first.getSource() && second.getSource())
+	{
+		return sameValue(first, second);
+	}
+
+	const QStringList values1 = first.getItemValue().split(' ', QString::SkipEmptyParts);
+	const QStringList values2 = second.getItemValue().split(' ', QString::SkipEmptyParts);
+
+	if (values1.size() != values2.size())
+	{
+		return false;
+	}
+
+	for (int i = 0; i < values1.size(); i++)
+	{
+		bool ok1 = false;
+		bool ok2 = false;
+		const double value1 = values1[i].toDouble(&ok1);
+		const double value2 = values2[i].toDouble(&ok2);
+
+		if (ok1 && ok2 ? std::fabs(value1 - value2) > this->options.tolerance : values1[i] != values2[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+QStringList DcmComparePolicy::uids(const DcmWidgetElement& element)
+{
+	DcmElement* source = element.getSource();
+
+	if (!source)
+	{
+		return element.getItemValue().split(' ', QString::SkipEmptyParts);
+	}
+
+	OFString value;
+	source->getOFStringArray(value);
+	return QString::fromLatin1(value.c_str()).split('\\', QString::SkipEmptyParts);
+}
+
+//========================================================================================================================
+void DcmComparePolicy::collectUids(const std::vector<DcmWidgetElement>& elements, std::map<QString, QStringList>& found)
+{
+	std::vector<std::pair<int, QString>> sequences;
+
+	// UIDs are paired by the path of enclosing sequences and their order within it
+	for (const auto& element : elements)
+	{
+		const QString tag = element.getItemTag().trimmed();
+
+		if (tag.startsWith("(FFFE,"))
+		{
+			continue;
+		}
+
+		while (!sequences.empty() && sequences.back().first >= element.getDepth())
+		{
+			sequences.pop_back();
+		}
+
+		const QString path = sequences.empty() ? tag : sequences.back().second + '/' + tag;
+
+		if (element.getItemVR() == "SQ")
+		{
+			sequences.emplace_back(element.getDepth(), path);
+		}
+
+		else if (element.getItemVR() == "UI")
+		{
+			found[path].append(uids(element));
+		}
+	}
+}
+
+//========================================================================================================================
+bool DcmComparePolicy::uidEqual(const DcmWidgetElement& first, const DcmWidgetElement& second) const
+{
+	const QStringList values1 = uids(first);
+	const QStringList values2 = uids(second);
+
+	if (values1.size() != values2.size())
+	{
+		return false;
+	}
+
+	// a UID may be replaced, but every occurrence has to be replaced by the same new UID
+	for (int i = 0; i < values1.size(); i++)
+	{
+		if (values1[i] == values2[i] && !this->forward.contains(values1[i]) && !this->backward.contains(values2[i]))
+		{
+			continue;
+		}
+
+		if (this->conflictsFirst.contains(values1[i]) || this->conflictsSecond.contains(values2[i])
+			|| this->forward.value(values1[i]) != values2[i] || this->backward.value(values2[i]) != values1[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <map>
+#include <vector>
+#include "DcmWidgetElement.h"
+#include "dcmtk/dcmdata/dctagkey.h"
+
+class DcmComparePolicy
+{
+	public:
+		struct Options
+		{
+			QString ignore;
+			double tolerance = -1;
+			bool uids = false;
+			bool padding = false;
+		};
+
+		bool setOptions(const Options& options, QString& error);
+		const Options& getOptions() const;
+		void reset();
+		void learnUids(const std::vector<DcmWidgetElement>& first, const std::vector<DcmWidgetElement>& second);
+		bool isActive() const;
+		bool ignores(const DcmWidgetElement& element) const;
+		bool equal(const DcmWidgetElement& first, const DcmWidgetElement& second);
+
+	private:
+		Options options;
+		QSet<Uint32> tags;
+		QSet<Uint16> groups;
+		QHash<QString, QString> forward;
+		QHash<QString, QString> backward;
+		QSet<QString> conflictsFirst;
+		QSet<QString> conflictsSecond;
+
+		static bool sameValue(const DcmWidgetElement& first, const DcmWidgetElement& second);
+		static bool numbers(const DcmWidgetElement& element, std::vector<double>& values);
+		static QStringList uids(const DcmWidgetElement& element);
+		static void collectUids(const std::vector<DcmWidgetElement>& elements, std::map<QString, QStringList>& found);
+		bool numericEqual(const DcmWidgetElement& first, const DcmWidgetElement& second) const;
+		bool uidEqual(const DcmWidgetElement& first, const DcmWidgetElement& second) const;
+};
@@ -0,0 +1,227 @@
+#include "DcmCompareReport.h"
+#include <QCommandLineParser>
+#include <QFile>
+#include <algorithm>
+#include <iostream>
+#include "CompareDialog.h"
+#include "DcmValueFormatter.h"
+
+#define COMPARE_FLAG "--compare"
+
+bool DcmCompareReport::isRequested(const QStringList& arguments)
+{
+	return arguments.contains(COMPARE_FLAG);
+}
+
+//========================================================================================================================
+int DcmCompareReport::run(const QStringList& arguments)
+{
+	QCommandLineParser parser;
+	parser.addOption(QCommandLineOption("compare", "First file.", "file"));
+	parser.addOption(QCommandLineOption("against", "Second file.", "file"));
+	parser.addOption(QCommandLineOption("report", "Report file, .csv for CSV, JSON lines otherwise.", "file"));
+	parser.addOption(QCommandLineOption("ignore", "Tags or groups to ignore, e.g. \"(0008,0018) (0009,xxxx)\".", "tags"));
+	parser.addOption(QCommandLineOption("tolerance", "Tolerance for DS, FD and FL values.", "value", "-1"));
+	parser.addOption(QCommandLineOption("uids", "Accept consistently replaced UIDs."));
+	parser.addOption(QCommandLineOption("padding", "Ignore length differences from padding."));
+
+	if (!parser.parse(arguments) || parser.value("against").isEmpty() || parser.value("report").isEmpty())
+	{
+		std::cerr << (parser.errorText().isEmpty() ? std::string("Usage: --compare <file> --against <file> --report <file>") : parser.errorText().toStdString()) << std::endl;
+		return 2;
+	}
+
+	DcmCompareReport report;
+
+	if (!report.open(parser.value("report")))
+	{
+		std::cerr << "Cannot open " << parser.value("report").toStdString() << std::endl;
+		return 2;
+	}
+
+	// rows go straight to the report, nothing of the diff script is kept
+	CompareDialog dialog(nullptr);
+	dialog.report = &report;
+	dialog.keepRows = false;
+
+	DcmComparePolicy::Options options;
+	options.ignore = parser.value("ignore");
+	options.tolerance = parser.value("tolerance").toDouble();
+	options.uids = parser.isSet("uids");
+	options.padding = parser.isSet("padding");
+	QString error;
+
+	if (!dialog.policy.setOptions(options, error))
+	{
+		std::cerr << error.toStdString() << std::endl;
+		return 2;
+	}
+
+	if (!dialog.loadFile(&dialog.file1, parser.value("compare"), true) || !dialog.loadFile(&dialog.file2, parser.value("against"), false))
+	{
+		std::cerr << "Failed to open file!" << std::endl;
+		return 2;
+	}
+
+	dialog.merge();
+	dialog.report = nullptr;
+
+	if (!report.close())
+	{
+		std::cerr << "Failed to write " << parser.value("report").toStdString() << std::endl;
+		return 2;
+	}
+
+	std::cerr << report.getWritten() << " differences" << std::endl;
+	return report.getWritten() ? 1 : 0;
+}
+
+//========================================================================================================================
+bool DcmCompareReport::open(const QString& fileName)
+{
+	this->format = fileName.endsWith(".csv", Qt::CaseInsensitive) ? Format::Csv : Format::JsonLines;
+	this->containers.clear();
+	this->written = 0;
+	this->file.open(QFile::encodeName(fileName).toStdString(), std::ios::out | std::ios::trunc);
+
+	if (this->file && this->format == Format::Csv)
+	{
+		this->file << "path,kind,vr,length1,value1,length2,value2\n";
+	}
+
+	return this->file.good();
+}
+
+//========================================================================================================================
+void DcmCompareReport::write(const DcmCompareModel::Row& row)
+{
+	const DcmWidgetElement& element = row.kind == DcmCompareModel::Added ? row.right : row.left;
+	const QString description = element.getItemDescription();
+	const int depth = std::max(element.getDepth(), 0);
+
+	while (!this->containers.empty() && this->containers.back().depth >= depth)
+	{
+		this->containers.pop_back();
+	}
+
+	if (description == "ItemDelimitationItem" || description == "SequenceDelimitationItem")
+	{
+		return;
+	}
+
+	// paths look like (0040,0275)[1].(0008,0100), items are numbered from one inside their sequence
+	QString path = this->containers.empty() ? QString() : this->containers.back().path;
+
+	if (description == "Item")
+	{
+		path += "[" + QString::number(this->containers.empty() ? 1 : ++this->containers.back().items) + "]";
+	}
+
+	else
+	{
+		path += (path.isEmpty() ? "" : ".") + element.getItemTag().trimmed();
+	}
+
+	if (element.getItemVR() == "SQ" || description == "Item")
+	{
+		this->containers.push_back(Container{ depth, path, 0 });
+	}
+
+	if (row.kind == DcmCompareModel::Equal)
+	{
+		return;
+	}
+
+	const char* kind = row.kind == DcmCompareModel::Changed ? "changed" : row.kind == DcmCompareModel::Added ? "added" : "removed";
+
+	// the table shows a preview, the report is a QA record and carries the complete values
+	const QString value1 = fullValue(row.left);
+	const QString value2 = fullValue(row.right);
+
+	if (this->format == Format::Csv)
+	{
+		this->file << escapeCsv(path) << ',' << kind << ',' << escapeCsv(element.getItemVR()) << ',' << row.left.getItemLength().toStdString() << ','
+			<< escapeCsv(value1) << ',' << row.right.getItemLength().toStdString() << ',' << escapeCsv(value2) << '\n';
+	}
+
+	else
+	{
+		const QString& length1 = row.left.getItemLength();
+		const QString& length2 = row.right.getItemLength();
+
+		this->file << "{\"path\":\"" << escapeJson(path) << "\",\"kind\":\"" << kind << "\",\"vr\":\"" << escapeJson(element.getItemVR())
+			<< "\",\"length1\":" << (length1.isEmpty() ? std::string("null") : length1.toStdString()) << ",\"value1\":\"" << escapeJson(value1)
+			<< "\",\"length2\":" << (length2.isEmpty() ? std::string("null") : length2.toStdString()) << ",\"value2\":\"" << escapeJson(value2) << "\"}\n";
+	}
+
+	this->written++;
+}
+
+//========================================================================================================================
+bool DcmCompareReport::close()
+{
+	this->file.close();
+	return !this->file.fail();
+}
+
+//========================================================================================================================
+unsigned long DcmCompareReport::getWritten() const
+{
+	return this->written;
+}
+
+//========================================================================================================================
+QString DcmCompareReport::fullValue(const DcmWidgetElement& element)
+{
+	return element.getSource() ? DcmValueFormatter::full(element.getSource()) : element.getItemValue();
+}
+
+//========================================================================================================================
+std::string DcmCompareReport::escapeJson(const QString& text)
+{
+	const std::string utf8 = text.toStdString();
+	std::string result;
+	result.reserve(utf8.size());
+
+	for (const char c : utf8)
+	{
+		if (c == '"' || c == '\\')
+		{
+			result += '\\';
+			result += c;
+		}
+
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			static const char hex[] = "0123456789abcdef";
+			result += "\\u00";
+			result += hex[(c >> 4) & 0xF];
+			result += hex[c & 0xF];
+		}
+
+		else
+		{
+			result += c;
+		}
+	}
+
+	return result;
+}
+
+//========================================================================================================================
+std::string DcmCompareReport::escapeCsv(const QString& text)
+{
+	std::string result = "\"";
+
+	for (const char c : text.toStdString())
+	{
+		result += c;
+
+		if (c == '"')
+		{
+			result += '"';
+		}
+	}
+
+	return result + "\"";
+}
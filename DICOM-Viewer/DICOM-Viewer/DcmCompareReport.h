@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "DcmCompareModel.h"
+
+class DcmCompareReport
+{
+	public:
+		enum class Format
+		{
+			JsonLines,
+			Csv
+		};
+
+		static bool isRequested(const QStringList& arguments);
+		static int run(const QStringList& arguments);
+		static std::string escapeJson(const QString& text);
+
+		bool open(const QString& fileName);
+		void write(const DcmCompareModel::Row& row);
+		bool close();
+		unsigned long getWritten() const;
+
+	private:
+		struct Container
+		{
+			int depth;
+			QString path;
+			int items;
+		};
+
+		std::ofstream file;
+		Format format = Format::JsonLines;
+		std::vector<Container> containers;
+		unsigned long written = 0;
+
+		static QString fullValue(const DcmWidgetElement& element);
+		static std::string escapeCsv(const QString& text);
+};
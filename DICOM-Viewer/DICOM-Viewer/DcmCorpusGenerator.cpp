@@ -0,0 +1,110 @@
+#include "DcmCorpusGenerator.h"
+#include <random>
+#include <vector>
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcuid.h"
+
+#define ELEMENTS_PER_BLOCK 256
+#define BLOCKS_PER_GROUP 240
+
+OFCondition DcmCorpusGenerator::generate(const std::string& fileName, const Options& options)
+{
+	DcmFileFormat file;
+	populate(file, options);
+	return file.saveFile(fileName.c_str(), EXS_LittleEndianExplicit);
+}
+
+//========================================================================================================================
+void DcmCorpusGenerator::populate(DcmFileFormat& file, const Options& options)
+{
+	char uid[100];
+	DcmDataset* dataSet = file.getDataset();
+
+	dataSet->putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+	dataSet->putAndInsertString(DCM_SOPInstanceUID, dcmGenerateUniqueIdentifier(uid, SITE_INSTANCE_UID_ROOT));
+	dataSet->putAndInsertString(DCM_StudyInstanceUID, dcmGenerateUniqueIdentifier(uid, SITE_STUDY_UID_ROOT));
+	dataSet->putAndInsertString(DCM_SeriesInstanceUID, dcmGenerateUniqueIdentifier(uid, SITE_SERIES_UID_ROOT));
+	dataSet->putAndInsertString(DCM_PatientName, "BENCHMARK^SYNTHETIC");
+	dataSet->putAndInsertString(DCM_PatientID, ("BENCH" + std::to_string(options.seed)).c_str());
+	dataSet->putAndInsertString(DCM_Modality, "OT");
+
+	addElements(dataSet, options);
+
+	if (options.sequenceDepth > 0)
+	{
+		addSequence(dataSet, options, options.sequenceDepth);
+	}
+
+	if (options.frames > 0 && options.rows > 0 && options.columns > 0)
+	{
+		addPixelData(dataSet, options);
+	}
+}
+
+//========================================================================================================================
+void DcmCorpusGenerator::addElements(DcmItem* item, const Options& options)
+{
+	std::mt19937 random(options.seed);
+	std::uniform_int_distribution<int> distribution(0, 9999);
+
+	for (unsigned long i = 0; i < options.elements; i++)
+	{
+		const Uint16 group = OFstatic_cast(Uint16, 0x0009 + 2 * (i / (ELEMENTS_PER_BLOCK * BLOCKS_PER_GROUP)));
+		const Uint16 block = OFstatic_cast(Uint16, 0x10 + (i / ELEMENTS_PER_BLOCK) % BLOCKS_PER_GROUP);
+		const Uint16 element = OFstatic_cast(Uint16, (block << 8) | (i % ELEMENTS_PER_BLOCK));
+
+		if (i % ELEMENTS_PER_BLOCK == 0)
+		{
+			item->putAndInsertString(DcmTag(group, block, EVR_LO), "BENCHMARK");
+		}
+
+		const std::string value = "VALUE " + std::to_string(i) + "\\" + std::to_string(distribution(random));
+		item->putAndInsertString(DcmTag(group, element, EVR_LO), value.c_str());
+	}
+}
+
+//========================================================================================================================
+void DcmCorpusGenerator::addSequence(DcmItem* item, const Options& options, const int depth)
+{
+	for (int i = 0; i < options.itemsPerSequence; i++)
+	{
+		DcmItem* child = nullptr;
+
+		if (item->findOrCreateSequenceItem(DCM_ContentSequence, child, -2).bad())
+		{
+			return;
+		}
+
+		child->putAndInsertString(DCM_RelationshipType, "CONTAINS");
+		child->putAndInsertString(DCM_ValueType, "TEXT");
+		child->putAndInsertString(DCM_TextValue, ("LEVEL " + std::to_string(depth) + " ITEM " + std::to_string(i)).c_str());
+
+		if (i == 0 && depth > 1)
+		{
+			addSequence(child, options, depth - 1);
+		}
+	}
+}
+
+//========================================================================================================================
+void DcmCorpusGenerator::addPixelData(DcmItem* item, const Options& options)
+{
+	const unsigned long frameSize = OFstatic_cast(unsigned long, options.rows) * options.columns;
+	std::vector<Uint16> pixels(frameSize * options.frames);
+
+	for (size_t i = 0; i < pixels.size(); i++)
+	{
+		pixels[i] = OFstatic_cast(Uint16, (i * 7 + options.seed) & 0x0FFF);
+	}
+
+	item->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+	item->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+	item->putAndInsertString(DCM_NumberOfFrames, std::to_string(options.frames).c_str());
+	item->putAndInsertUint16(DCM_Rows, options.rows);
+	item->putAndInsertUint16(DCM_Columns, options.columns);
+	item->putAndInsertUint16(DCM_BitsAllocated, 16);
+	item->putAndInsertUint16(DCM_BitsStored, 12);
+	item->putAndInsertUint16(DCM_HighBit, 11);
+	item->putAndInsertUint16(DCM_PixelRepresentation, 0);
+	item->putAndInsertUint16Array(DCM_PixelData, pixels.data(), OFstatic_cast(unsigned long, pixels.size()));
+}
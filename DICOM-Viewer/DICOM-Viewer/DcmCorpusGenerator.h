@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include "dcmtk/dcmdata/dcfilefo.h"
+
+class DcmCorpusGenerator
+{
+	public:
+		struct Options
+		{
+			unsigned long elements = 1000;
+			int sequenceDepth = 4;
+			int itemsPerSequence = 3;
+			int frames = 1;
+			Uint16 rows = 256;
+			Uint16 columns = 256;
+			unsigned int seed = 1;
+		};
+
+		static OFCondition generate(const std::string& fileName, const Options& options);
+		static void populate(DcmFileFormat& file, const Options& options);
+
+	private:
+		static void addElements(DcmItem* item, const Options& options);
+		static void addSequence(DcmItem* item, const Options& options, int depth);
+		static void addPixelData(DcmItem* item, const Options& options);
+};
@@ -0,0 +1,182 @@
+#include "DcmCsaHeader.h"
+#include <cstring>
+#include "DcmPrivateDictionary.h"
+
+// guards against garbage counts in damaged headers
+#define MAX_CSA_ITEMS 1000
+#define CSA_NAME_LENGTH 64
+#define CSA_TAG_LENGTH 84
+#define CSA_ITEM_HEADER_LENGTH 16
+
+bool DcmCsaHeader::isHeader(DcmElement* element)
+{
+	const DcmTagKey tag = element->getTag().getBaseTag();
+
+	if (tag.getGroup() != 0x0029 || ((tag.getElement() & 0xFF) != 0x10 && (tag.getElement() & 0xFF) != 0x20) || element->getLength() < 16)
+	{
+		return false;
+	}
+
+	const QString creator = DcmPrivateDictionary::creatorOf(element);
+	return creator == "SIEMENS CSA HEADER" || creator == "SIEMENS CSA NON-IMAGE";
+}
+
+//========================================================================================================================
+bool DcmCsaHeader::parse(DcmElement* element)
+{
+	Uint8* data = nullptr;
+
+	if (element->getUint8Array(data).bad() || !data)
+	{
+		this->error = "The element has no byte value";
+		return false;
+	}
+
+	return this->parse(data, element->getLength());
+}
+
+//========================================================================================================================
+bool DcmCsaHeader::parse(const Uint8* data, const size_t length)
+{
+	this->entries.clear();
+	this->error.clear();
+
+	// CSA2 starts with "SV10" and four unused bytes, CSA1 starts right at the tag count
+	const bool csa2 = length >= 4 && std::memcmp(data, "SV10", 4) == 0;
+	size_t offset = csa2 ? 8 : 0;
+
+	if (offset + 8 > length)
+	{
+		this->error = "Header too short";
+		return false;
+	}
+
+	const Sint32 count = readInt(data + offset);
+	offset += 8;
+
+	if (count <= 0 || count > MAX_CSA_ITEMS)
+	{
+		this->error = "Invalid tag count " + QString::number(count);
+		return false;
+	}
+
+	Sint32 firstItems = 0;
+	this->entries.reserve(count);
+
+	for (Sint32 tag = 0; tag < count; tag++)
+	{
+		if (offset + CSA_TAG_LENGTH > length)
+		{
+			this->error = "Truncated at tag " + QString::number(tag);
+			return false;
+		}
+
+		Entry entry;
+		entry.name = text(data + offset, CSA_NAME_LENGTH);
+		entry.vm = readInt(data + offset + 64);
+		entry.vr = text(data + offset + 68, 4);
+		const Sint32 items = readInt(data + offset + 76);
+		offset += CSA_TAG_LENGTH;
+
+		if (items < 0 || items > MAX_CSA_ITEMS)
+		{
+			this->error = "Invalid item count in " + entry.name;
+			return false;
+		}
+
+		if (tag == 1)
+		{
+			firstItems = items;
+		}
+
+		const Sint32 values = entry.vm ? entry.vm : items;
+
+		for (Sint32 item = 0; item < items; item++)
+		{
+			if (offset + CSA_ITEM_HEADER_LENGTH > length)
+			{
+				this->error = "Truncated in " + entry.name;
+				return false;
+			}
+
+			// CSA1 stores the item length offset by the item count of the second tag
+			const Sint32 itemLength = csa2 ? readInt(data + offset + 4) : readInt(data + offset) - firstItems;
+			offset += CSA_ITEM_HEADER_LENGTH;
+
+			if (itemLength < 0 || offset + itemLength > length)
+			{
+				if (csa2)
+				{
+					this->error = "Item too long in " + entry.name;
+					return false;
+				}
+
+				break;
+			}
+
+			if (item < values)
+			{
+				entry.values.append(text(data + offset, itemLength));
+			}
+
+			offset += (itemLength + 3) & ~3;
+		}
+
+		this->entries.push_back(std::move(entry));
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+const std::vector<DcmCsaHeader::Entry>& DcmCsaHeader::getEntries() const
+{
+	return this->entries;
+}
+
+//========================================================================================================================
+const QString& DcmCsaHeader::getError() const
+{
+	return this->error;
+}
+
+//========================================================================================================================
+QStringList DcmCsaHeader::format() const
+{
+	QStringList lines;
+
+	for (const Entry& entry : this->entries)
+	{
+		QStringList values;
+
+		for (const QString& value : entry.values)
+		{
+			if (!value.isEmpty())
+			{
+				values.append(value);
+			}
+		}
+
+		if (!values.isEmpty())
+		{
+			lines.append(entry.name + " [" + entry.vr + "]: " + values.join('\\'));
+		}
+	}
+
+	return lines;
+}
+
+//========================================================================================================================
+QString DcmCsaHeader::text(const Uint8* data, const size_t length)
+{
+	// values are NUL terminated inside their slot and often padded with spaces
+	const void* end = std::memchr(data, 0, length);
+	const size_t size = end ? OFstatic_cast(const Uint8*, end) - data : length;
+	return QString::fromLatin1(reinterpret_cast<const char*>(data), static_cast<int>(size)).trimmed();
+}
+
+//========================================================================================================================
+Sint32 DcmCsaHeader::readInt(const Uint8* data)
+{
+	return OFstatic_cast(Sint32, OFstatic_cast(Uint32, data[0]) | OFstatic_cast(Uint32, data[1]) << 8 | OFstatic_cast(Uint32, data[2]) << 16 | OFstatic_cast(Uint32, data[3]) << 24);
+}
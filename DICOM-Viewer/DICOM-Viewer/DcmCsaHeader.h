@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <vector>
+#include "dcmtk/dcmdata/dcelem.h"
+
+class DcmCsaHeader
+{
+	public:
+		struct Entry
+		{
+			QString name;
+			QString vr;
+			int vm = 0;
+			QStringList values;
+		};
+
+		static bool isHeader(DcmElement* element);
+		bool parse(const Uint8* data, size_t length);
+		bool parse(DcmElement* element);
+		const std::vector<Entry>& getEntries() const;
+		const QString& getError() const;
+		QStringList format() const;
+
+	private:
+		std::vector<Entry> entries;
+		QString error;
+		static QString text(const Uint8* data, size_t length);
+		static Sint32 readInt(const Uint8* data);
+};
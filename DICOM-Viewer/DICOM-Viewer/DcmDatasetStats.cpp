@@ -0,0 +1,213 @@
+#include "DcmDatasetStats.h"
+#include <algorithm>
+#include "dcmtk/dcmdata/dcelem.h"
+
+// only the largest elements are kept, as a min-heap on length
+#define LARGEST_COUNT 20
+
+static bool longer(const DcmDatasetStats::Element& first, const DcmDatasetStats::Element& second)
+{
+	return first.length > second.length;
+}
+
+//========================================================================================================================
+void DcmDatasetStats::add(const DcmTagKey& tag, const DcmEVR vr, const Uint32 length, const int depth)
+{
+	this->elements++;
+	this->vrs[vr]++;
+
+	if (tag.getGroup() & 1)
+	{
+		this->privateElements++;
+	}
+
+	// row depth counts items as well as sequences, the histogram is by sequence nesting
+	const size_t level = static_cast<size_t>(std::max(depth, 0)) / 2;
+
+	if (level >= this->depths.size())
+	{
+		this->depths.resize(level + 1);
+	}
+
+	this->depths[level]++;
+	Group& group = this->groups[tag.getGroup()];
+	group.elements++;
+
+	// sequence lengths cover their nested elements, which are counted on their own
+	if (vr == EVR_SQ || length == DCM_UndefinedLength)
+	{
+		return;
+	}
+
+	group.bytes += length;
+	this->bytes += length;
+
+	if (this->largest.size() < LARGEST_COUNT || length > this->largest.front().length)
+	{
+		this->keepLargest(Element{ tag, vr, length, static_cast<int>(level), this->file });
+	}
+}
+
+//========================================================================================================================
+void DcmDatasetStats::addRow(const DcmWidgetElement& row)
+{
+	DcmElement* source = row.getSource();
+
+	if (source)
+	{
+		// the tag carries the VR as encoded, ident() reports pixel data as the internal EVR_PixelData
+		const DcmEVR vr = source->getTag().getEVR();
+		this->add(source->getTag().getBaseTag(), vr, vr == EVR_SQ ? 0 : source->getLength(), row.getDepth());
+		return;
+	}
+
+	// items, delimiters and damaged regions are table rows but not elements
+	DcmTagKey tag;
+
+	if (!parseTag(row.getItemTag(), tag) || tag.getGroup() == 0xFFFE || tag.getGroup() == 0xFFFF)
+	{
+		return;
+	}
+
+	const DcmEVR vr = DcmVR(row.getItemVR().toLatin1().constData()).getEVR();
+	this->add(tag, vr, vr == EVR_SQ ? 0 : row.getItemLength().toUInt(), row.getDepth());
+}
+
+//========================================================================================================================
+void DcmDatasetStats::merge(const DcmDatasetStats& other)
+{
+	for (const auto& group : other.groups)
+	{
+		Group& target = this->groups[group.first];
+		target.elements += group.second.elements;
+		target.bytes += group.second.bytes;
+	}
+
+	for (const auto& vr : other.vrs)
+	{
+		this->vrs[vr.first] += vr.second;
+	}
+
+	if (other.depths.size() > this->depths.size())
+	{
+		this->depths.resize(other.depths.size());
+	}
+
+	for (size_t depth = 0; depth < other.depths.size(); depth++)
+	{
+		this->depths[depth] += other.depths[depth];
+	}
+
+	for (const Element& element : other.largest)
+	{
+		if (this->largest.size() < LARGEST_COUNT || element.length > this->largest.front().length)
+		{
+			this->keepLargest(element);
+		}
+	}
+
+	this->elements += other.elements;
+	this->privateElements += other.privateElements;
+	this->bytes += other.bytes;
+	this->files += std::max<Uint64>(other.files, 1);
+}
+
+//========================================================================================================================
+void DcmDatasetStats::keepLargest(const Element& element)
+{
+	if (this->largest.size() == LARGEST_COUNT)
+	{
+		std::pop_heap(this->largest.begin(), this->largest.end(), longer);
+		this->largest.pop_back();
+	}
+
+	this->largest.push_back(element);
+	std::push_heap(this->largest.begin(), this->largest.end(), longer);
+}
+
+//========================================================================================================================
+bool DcmDatasetStats::parseTag(const QString& text, DcmTagKey& tag)
+{
+	const int open = text.indexOf('(');
+
+	if (open < 0 || text.size() < open + 11 || text[open + 5] != ',')
+	{
+		return false;
+	}
+
+	bool groupOk = false;
+	bool elementOk = false;
+	const Uint16 group = OFstatic_cast(Uint16, text.midRef(open + 1, 4).toUInt(&groupOk, 16));
+	const Uint16 element = OFstatic_cast(Uint16, text.midRef(open + 6, 4).toUInt(&elementOk, 16));
+	tag.set(group, element);
+	return groupOk && elementOk;
+}
+
+//========================================================================================================================
+void DcmDatasetStats::clear()
+{
+	this->groups.clear();
+	this->vrs.clear();
+	this->depths.clear();
+	this->largest.clear();
+	this->elements = 0;
+	this->privateElements = 0;
+	this->bytes = 0;
+	this->files = 0;
+}
+
+//========================================================================================================================
+void DcmDatasetStats::setFile(const QString& file)
+{
+	this->file = file;
+}
+
+//========================================================================================================================
+Uint64 DcmDatasetStats::getElementCount() const
+{
+	return this->elements;
+}
+
+//========================================================================================================================
+Uint64 DcmDatasetStats::getPrivateCount() const
+{
+	return this->privateElements;
+}
+
+//========================================================================================================================
+Uint64 DcmDatasetStats::getTotalBytes() const
+{
+	return this->bytes;
+}
+
+//========================================================================================================================
+Uint64 DcmDatasetStats::getFileCount() const
+{
+	return this->files;
+}
+
+//========================================================================================================================
+const std::map<Uint16, DcmDatasetStats::Group>& DcmDatasetStats::getGroups() const
+{
+	return this->groups;
+}
+
+//========================================================================================================================
+const std::map<DcmEVR, Uint64>& DcmDatasetStats::getVRs() const
+{
+	return this->vrs;
+}
+
+//========================================================================================================================
+const std::vector<Uint64>& DcmDatasetStats::getDepths() const
+{
+	return this->depths;
+}
+
+//========================================================================================================================
+std::vector<DcmDatasetStats::Element> DcmDatasetStats::getLargest() const
+{
+	std::vector<Element> sorted = this->largest;
+	std::sort(sorted.begin(), sorted.end(), longer);
+	return sorted;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QString>
+#include <map>
+#include <vector>
+#include "dcmtk/dcmdata/dctagkey.h"
+#include "dcmtk/dcmdata/dcvr.h"
+#include "DcmWidgetElement.h"
+
+class DcmDatasetStats
+{
+	public:
+		struct Group
+		{
+			Uint64 elements = 0;
+			Uint64 bytes = 0;
+		};
+
+		struct Element
+		{
+			DcmTagKey tag;
+			DcmEVR vr;
+			Uint32 length;
+			int depth;
+			QString file;
+		};
+
+		void add(const DcmTagKey& tag, DcmEVR vr, Uint32 length, int depth);
+		void addRow(const DcmWidgetElement& row);
+		void merge(const DcmDatasetStats& other);
+		void clear();
+		void setFile(const QString& file);
+		Uint64 getElementCount() const;
+		Uint64 getPrivateCount() const;
+		Uint64 getTotalBytes() const;
+		Uint64 getFileCount() const;
+		const std::map<Uint16, Group>& getGroups() const;
+		const std::map<DcmEVR, Uint64>& getVRs() const;
+		const std::vector<Uint64>& getDepths() const;
+		std::vector<Element> getLargest() const;
+
+	private:
+		std::map<Uint16, Group> groups;
+		std::map<DcmEVR, Uint64> vrs;
+		std::vector<Uint64> depths;
+		std::vector<Element> largest;
+		Uint64 elements = 0;
+		Uint64 privateElements = 0;
+		Uint64 bytes = 0;
+		Uint64 files = 0;
+		QString file;
+		void keepLargest(const Element& element);
+		static bool parseTag(const QString& text, DcmTagKey& tag);
+};
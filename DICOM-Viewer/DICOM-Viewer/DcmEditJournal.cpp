@@ -0,0 +1,396 @@
+#include "DcmEditJournal.h"
+
+void DcmEditJournal::setTarget(DcmFileFormat* file, DcmFastSave* fastSave)
+{
+	this->clear();
+	this->file = file;
+	this->fastSave = fastSave;
+}
+
+//========================================================================================================================
+void DcmEditJournal::clear()
+{
+	this->undoStack.clear();
+	this->redoStack.clear();
+	this->pending.clear();
+	this->batching = false;
+}
+
+//========================================================================================================================
+void DcmEditJournal::beginBatch()
+{
+	this->commitBatch();
+	this->batching = true;
+}
+
+//========================================================================================================================
+void DcmEditJournal::commitBatch()
+{
+	if (!this->pending.empty())
+	{
+		this->undoStack.push_back(std::move(this->pending));
+		this->pending.clear();
+	}
+
+	this->batching = false;
+}
+
+//========================================================================================================================
+bool DcmEditJournal::inBatch() const
+{
+	return this->batching;
+}
+
+//========================================================================================================================
+bool DcmEditJournal::canUndo() const
+{
+	return !this->undoStack.empty() || !this->pending.empty();
+}
+
+//========================================================================================================================
+bool DcmEditJournal::canRedo() const
+{
+	return !this->redoStack.empty();
+}
+
+//========================================================================================================================
+bool DcmEditJournal::undo()
+{
+	this->commitBatch();
+
+	if (this->undoStack.empty())
+	{
+		return false;
+	}
+
+	std::vector<Step> group = std::move(this->undoStack.back());
+	this->undoStack.pop_back();
+	bool ok = true;
+
+	for (auto step = group.rbegin(); step != group.rend(); ++step)
+	{
+		ok = this->revert(*step).good() && ok;
+		this->markDirty(*step);
+	}
+
+	this->redoStack.push_back(std::move(group));
+	return ok;
+}
+
+//========================================================================================================================
+bool DcmEditJournal::redo()
+{
+	if (this->redoStack.empty())
+	{
+		return false;
+	}
+
+	std::vector<Step> group = std::move(this->redoStack.back());
+	this->redoStack.pop_back();
+	bool ok = true;
+
+	for (auto& step : group)
+	{
+		ok = this->execute(step).good() && ok;
+		this->markDirty(step);
+	}
+
+	this->undoStack.push_back(std::move(group));
+	return ok;
+}
+
+//========================================================================================================================
+OFCondition DcmEditJournal::modifyValue(const Path& path, const DcmTagKey& tag, const OFString& value)
+{
+	DcmItem* container = this->resolve(path);
+	DcmElement* element;
+
+	if (!container || container->findAndGetElement(tag, element, OFFalse).bad())
+	{
+		return EC_TagNotFound;
+	}
+
+	Step step;
+	step.operation = Operation::ModifyValue;
+	step.path = path;
+	step.tag = tag;
+	step.after = value;
+	element->getOFStringArray(step.before);
+
+	return this->record(std::move(step));
+}
+
+//========================================================================================================================
+OFCondition DcmEditJournal::insertString(const Path& path, const DcmTagKey& tag, const OFString& value)
+{
+	Step step;
+	step.operation = Operation::InsertString;
+	step.path = path;
+	step.tag = tag;
+	step.after = value;
+
+	return this->record(std::move(step));
+}
+
+//========================================================================================================================
+OFCondition DcmEditJournal::insertEmpty(const Path& path, const DcmTagKey& tag)
+{
+	Step step;
+	step.operation = Operation::InsertEmpty;
+	step.path = path;
+	step.tag = tag;
+
+	return this->record(std::move(step));
+}
+
+//========================================================================================================================
+OFCondition DcmEditJournal::insertItem(const Path& path, const DcmTagKey& sequenceTag, const DcmTagKey& itemTag)
+{
+	Step step;
+	step.operation = Operation::InsertItem;
+	step.path = path;
+	step.tag = sequenceTag;
+	step.itemTag = itemTag;
+
+	return this->record(std::move(step));
+}
+
+//========================================================================================================================
+OFCondition DcmEditJournal::removeElement(const Path& path, const DcmTagKey& tag)
+{
+	Step step;
+	step.operation = Operation::RemoveElement;
+	step.path = path;
+	step.tag = tag;
+
+	return this->record(std::move(step));
+}
+
+//========================================================================================================================
+OFCondition DcmEditJournal::removeItem(const Path& path, const DcmTagKey& sequenceTag, const unsigned long itemNumber)
+{
+	Step step;
+	step.operation = Operation::RemoveItem;
+	step.path = path;
+	step.tag = sequenceTag;
+	step.itemNumber = itemNumber;
+
+	return this->record(std::move(step));
+}
+
+//========================================================================================================================
+DcmItem* DcmEditJournal::resolve(const Path& path) const
+{
+	if (!this->file)
+	{
+		return nullptr;
+	}
+
+	DcmItem* item = this->file->getDataset();
+
+	for (const auto& node : path)
+	{
+		DcmItem* next = nullptr;
+
+		if (item->findAndGetSequenceItem(node.first, next, OFstatic_cast(signed long, node.second)).bad())
+		{
+			return nullptr;
+		}
+
+		item = next;
+	}
+
+	return item;
+}
+
+//========================================================================================================================
+OFCondition DcmEditJournal::record(Step step)
+{
+	const OFCondition cond = this->execute(step);
+
+	if (cond.bad())
+	{
+		return cond;
+	}
+
+	this->markDirty(step);
+	this->redoStack.clear();
+
+	if (this->batching)
+	{
+		this->pending.push_back(std::move(step));
+	}
+
+	else
+	{
+		std::vector<Step> group;
+		group.push_back(std::move(step));
+		this->undoStack.push_back(std::move(group));
+	}
+
+	return cond;
+}
+
+//========================================================================================================================
+OFCondition DcmEditJournal::execute(Step& step) const
+{
+	DcmItem* container = this->resolve(step.path);
+
+	if (!container)
+	{
+		return EC_IllegalCall;
+	}
+
+	switch (step.operation)
+	{
+		case Operation::ModifyValue:
+		{
+			DcmElement* element;
+			OFCondition cond = container->findAndGetElement(step.tag, element, OFFalse);
+			return cond.good() ? element->putString(step.after.c_str()) : cond;
+		}
+
+		case Operation::InsertString:
+			return container->putAndInsertString(step.tag, step.after.c_str(), OFFalse);
+
+		case Operation::InsertEmpty:
+			return container->insertEmptyElement(step.tag, OFFalse);
+
+		case Operation::InsertItem:
+		{
+			OFCondition cond = container->insertSequenceItem(step.tag, new DcmItem(DcmTag(step.itemTag)));
+			DcmSequenceOfItems* sequence;
+
+			if (cond.good() && container->findAndGetSequence(step.tag, sequence, OFFalse).good())
+			{
+				step.itemNumber = sequence->card() - 1;
+			}
+
+			return cond;
+		}
+
+		case Operation::RemoveElement:
+		{
+			DcmElement* removed = container->remove(step.tag);
+
+			if (!removed)
+			{
+				return EC_TagNotFound;
+			}
+
+			step.snapshot.reset(removed);
+			return EC_Normal;
+		}
+
+		case Operation::RemoveItem:
+		{
+			DcmSequenceOfItems* sequence;
+			OFCondition cond = container->findAndGetSequence(step.tag, sequence, OFFalse);
+
+			if (cond.bad())
+			{
+				return cond;
+			}
+
+			DcmItem* removed = sequence->remove(step.itemNumber);
+
+			if (!removed)
+			{
+				return EC_IllegalCall;
+			}
+
+			step.snapshot.reset(removed);
+			return EC_Normal;
+		}
+	}
+
+	return EC_IllegalCall;
+}
+
+//========================================================================================================================
+OFCondition DcmEditJournal::revert(Step& step) const
+{
+	DcmItem* container = this->resolve(step.path);
+
+	if (!container)
+	{
+		return EC_IllegalCall;
+	}
+
+	switch (step.operation)
+	{
+		case Operation::ModifyValue:
+		{
+			DcmElement* element;
+			OFCondition cond = container->findAndGetElement(step.tag, element, OFFalse);
+			return cond.good() ? element->putString(step.before.c_str()) : cond;
+		}
+
+		case Operation::InsertString:
+		case Operation::InsertEmpty:
+		{
+			DcmElement* removed = container->remove(step.tag);
+			delete removed;
+			return removed ? EC_Normal : EC_TagNotFound;
+		}
+
+		case Operation::InsertItem:
+		{
+			DcmSequenceOfItems* sequence;
+			OFCondition cond = container->findAndGetSequence(step.tag, sequence, OFFalse);
+
+			if (cond.good())
+			{
+				DcmItem* removed = sequence->remove(step.itemNumber);
+				delete removed;
+			}
+
+			return cond;
+		}
+
+		case Operation::RemoveElement:
+		{
+			auto* element = OFstatic_cast(DcmElement*, step.snapshot.release());
+			OFCondition cond = container->insert(element, OFFalse);
+
+			if (cond.bad())
+			{
+				step.snapshot.reset(element);
+			}
+
+			return cond;
+		}
+
+		case Operation::RemoveItem:
+		{
+			DcmSequenceOfItems* sequence;
+			OFCondition cond = container->findAndGetSequence(step.tag, sequence, OFFalse);
+
+			if (cond.bad())
+			{
+				return cond;
+			}
+
+			auto* item = OFstatic_cast(DcmItem*, step.snapshot.release());
+			cond = step.itemNumber == 0 ? sequence->insert(item, 0, OFTrue) : sequence->insert(item, step.itemNumber - 1);
+
+			if (cond.bad())
+			{
+				step.snapshot.reset(item);
+			}
+
+			return cond;
+		}
+	}
+
+	return EC_IllegalCall;
+}
+
+//========================================================================================================================
+void DcmEditJournal::markDirty(const Step& step) const
+{
+	if (this->fastSave)
+	{
+		this->fastSave->markDirty(step.path.empty() ? step.tag : step.path[0].first);
+	}
+}
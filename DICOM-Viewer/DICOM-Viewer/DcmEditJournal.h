@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcitem.h"
+#include "dcmtk/dcmdata/dcsequen.h"
+#include "DcmFastSave.h"
+
+class DcmEditJournal
+{
+	public:
+		typedef std::vector<std::pair<DcmTagKey, unsigned long>> Path;
+
+		DcmEditJournal() = default;
+		~DcmEditJournal() = default;
+
+		void setTarget(DcmFileFormat* file, DcmFastSave* fastSave);
+		void clear();
+		void beginBatch();
+		void commitBatch();
+		bool inBatch() const;
+		bool canUndo() const;
+		bool canRedo() const;
+		bool undo();
+		bool redo();
+		OFCondition modifyValue(const Path& path, const DcmTagKey& tag, const OFString& value);
+		OFCondition insertString(const Path& path, const DcmTagKey& tag, const OFString& value);
+		OFCondition insertEmpty(const Path& path, const DcmTagKey& tag);
+		OFCondition insertItem(const Path& path, const DcmTagKey& sequenceTag, const DcmTagKey& itemTag);
+		OFCondition removeElement(const Path& path, const DcmTagKey& tag);
+		OFCondition removeItem(const Path& path, const DcmTagKey& sequenceTag, unsigned long itemNumber);
+
+	private:
+		enum class Operation
+		{
+			ModifyValue,
+			InsertString,
+			InsertEmpty,
+			InsertItem,
+			RemoveElement,
+			RemoveItem
+		};
+
+		struct Step
+		{
+			Operation operation = Operation::ModifyValue;
+			Path path;
+			DcmTagKey tag;
+			DcmTagKey itemTag;
+			unsigned long itemNumber = 0;
+			OFString before;
+			OFString after;
+			std::unique_ptr<DcmObject> snapshot;
+		};
+
+		DcmFileFormat* file = nullptr;
+		DcmFastSave* fastSave = nullptr;
+		std::vector<std::vector<Step>> undoStack;
+		std::vector<std::vector<Step>> redoStack;
+		std::vector<Step> pending;
+		bool batching = false;
+
+		DcmItem* resolve(const Path& path) const;
+		OFCondition record(Step step);
+		OFCondition execute(Step& step) const;
+		OFCondition revert(Step& step) const;
+		void markDirty(const Step& step) const;
+};
@@ -0,0 +1,329 @@
+#include "DcmFastSave.h"
+#include "DcmStreamParser.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcostrmb.h"
+#include "dcmtk/dcmdata/dcxfer.h"
+#include <filesystem>
+#include <system_error>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <unistd.h>
+#endif
+
+#define COPY_BUFFER_SIZE 4194304
+
+class DcmRangeCollector final : public DcmStreamHandler
+{
+	public:
+		explicit DcmRangeCollector(std::map<DcmTagKey, DcmFastSave::Range>& ranges) : ranges(ranges) { }
+
+		bool onEvent(const DcmStreamEvent& event) override
+		{
+			if (event.depth != 0 || event.tag.getGroup() == 0x0002)
+			{
+				return true;
+			}
+
+			if (event.kind == DcmStreamEvent::Kind::SequenceStart)
+			{
+				this->ranges[event.tag].offset = event.offset;
+			}
+
+			else if (event.kind == DcmStreamEvent::Kind::SequenceEnd)
+			{
+				DcmFastSave::Range& range = this->ranges[event.tag];
+				range.length = event.offset - range.offset;
+			}
+
+			else if (event.kind == DcmStreamEvent::Kind::Element)
+			{
+				DcmFastSave::Range& range = this->ranges[event.tag];
+				range.offset = event.offset;
+				range.length = event.headerLength + event.valueLength;
+			}
+
+			return true;
+		}
+
+	private:
+		std::map<DcmTagKey, DcmFastSave::Range>& ranges;
+};
+
+void DcmFastSave::setSource(DcmFileFormat* file, const std::string& fileName)
+{
+	this->file = file;
+	this->sourceFileName = fileName;
+	this->dirty.clear();
+	this->cachedRanges.clear();
+	this->cachedMetaEnd = 0;
+}
+
+//========================================================================================================================
+void DcmFastSave::setRanges(const std::map<DcmTagKey, Range>& ranges, const offile_off_t metaEnd)
+{
+	this->cachedRanges = ranges;
+	this->cachedMetaEnd = metaEnd;
+}
+
+//========================================================================================================================
+void DcmFastSave::markDirty(const DcmTagKey& tag)
+{
+	this->dirty.insert(tag);
+}
+
+//========================================================================================================================
+void DcmFastSave::clear()
+{
+	this->file = nullptr;
+	this->sourceFileName.clear();
+	this->dirty.clear();
+	this->cachedRanges.clear();
+	this->cachedMetaEnd = 0;
+}
+
+//========================================================================================================================
+bool DcmFastSave::isDirty() const
+{
+	return !this->dirty.empty();
+}
+
+//========================================================================================================================
+OFCondition DcmFastSave::saveFile(const std::string& fileName)
+{
+	if (!this->file)
+	{
+		return EC_IllegalCall;
+	}
+
+	if (this->canSaveFast(fileName))
+	{
+		OFFile in;
+
+		if (in.fopen(this->sourceFileName.c_str(), "rb"))
+		{
+			const OFCondition cond = this->writeFast(in, fileName);
+			in.fclose();
+
+			if (cond.good())
+			{
+				return cond;
+			}
+		}
+	}
+
+	return this->file->saveFile(fileName.c_str());
+}
+
+//========================================================================================================================
+bool DcmFastSave::canSaveFast(const std::string& fileName) const
+{
+	if (this->sourceFileName.empty() || sameFile(fileName, this->sourceFileName))
+	{
+		return false;
+	}
+
+	// the meta header is copied verbatim, so anything it mirrors must be untouched
+	if (this->dirty.count(DCM_SOPClassUID) || this->dirty.count(DCM_SOPInstanceUID))
+	{
+		return false;
+	}
+
+	const DcmXfer xfer(this->file->getDataset()->getOriginalXfer());
+
+	return xfer.getXfer() != EXS_Unknown && xfer.getByteOrder() == EBO_LittleEndian && xfer.getStreamCompression() == ESC_none;
+}
+
+//========================================================================================================================
+bool DcmFastSave::sameFile(const std::string& first, const std::string& second)
+{
+	// symlinks, relative paths and case variants all resolve to the same file
+	std::error_code error;
+	return first == second || std::filesystem::equivalent(std::filesystem::u8path(first), std::filesystem::u8path(second), error);
+}
+
+//========================================================================================================================
+bool DcmFastSave::scanSource(std::map<DcmTagKey, Range>& ranges, offile_off_t& metaEnd) const
+{
+	DcmRangeCollector collector(ranges);
+	DcmStreamParser parser;
+	parser.setPreviewLength(0);
+
+	if (!parser.parseFile(this->sourceFileName, collector) || parser.getDatasetOffset() < 132)
+	{
+		return false;
+	}
+
+	metaEnd = parser.getDatasetOffset();
+	return true;
+}
+
+//========================================================================================================================
+bool DcmFastSave::copyRange(OFFile& in, OFFile& out, offile_off_t offset, offile_off_t length)
+{
+#ifdef __linux__
+	out.fflush();
+	loff_t inOffset = offset;
+
+	while (length > 0)
+	{
+		const ssize_t copied = copy_file_range(in.fileno(), &inOffset, out.fileno(), nullptr, length, 0);
+
+		if (copied <= 0)
+		{
+			break;
+		}
+
+		length -= copied;
+	}
+
+	off_t sendOffset = inOffset;
+
+	while (length > 0)
+	{
+		const ssize_t copied = sendfile(out.fileno(), in.fileno(), &sendOffset, length);
+
+		if (copied <= 0)
+		{
+			break;
+		}
+
+		length -= copied;
+	}
+
+	offset = sendOffset;
+	out.fseek(0, SEEK_END);
+
+	if (length == 0)
+	{
+		return true;
+	}
+#endif
+
+	std::vector<char> buffer(OFstatic_cast(size_t, length < COPY_BUFFER_SIZE ? length : COPY_BUFFER_SIZE));
+
+	if (in.fseek(offset, SEEK_SET) != 0)
+	{
+		return false;
+	}
+
+	while (length > 0)
+	{
+		const size_t chunk = OFstatic_cast(size_t, length < OFstatic_cast(offile_off_t, buffer.size()) ? length : buffer.size());
+
+		if (in.fread(buffer.data(), 1, chunk) != chunk || out.fwrite(buffer.data(), 1, chunk) != chunk)
+		{
+			return false;
+		}
+
+		length -= chunk;
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+OFCondition DcmFastSave::encodeElement(DcmObject* object, const E_TransferSyntax xfer, std::vector<char>& buffer)
+{
+	const Uint32 length = object->calcElementLength(xfer, EET_ExplicitLength);
+	buffer.resize(length);
+	DcmOutputBufferStream stream(buffer.data(), length);
+	object->transferInit();
+	OFCondition cond = object->write(stream, xfer, EET_ExplicitLength, nullptr);
+	object->transferEnd();
+
+	if (cond.good())
+	{
+		void* data;
+		offile_off_t written;
+		stream.flushBuffer(data, written);
+		buffer.resize(OFstatic_cast(size_t, written));
+	}
+
+	return cond;
+}
+
+//========================================================================================================================
+OFCondition DcmFastSave::writeFast(OFFile& in, const std::string& fileName)
+{
+	std::map<DcmTagKey, Range> ranges = this->cachedRanges;
+	offile_off_t metaEnd = this->cachedMetaEnd;
+
+	// the offset index built at load time already holds every top level range
+	if (metaEnd < 132 && !this->scanSource(ranges, metaEnd))
+	{
+		return EC_IllegalCall;
+	}
+
+	DcmDataset* dataSet = this->file->getDataset();
+	const E_TransferSyntax xfer = dataSet->getOriginalXfer();
+	std::set<DcmTagKey> encode = this->dirty;
+
+	for (const auto& tag : this->dirty)
+	{
+		encode.insert(DcmTagKey(tag.getGroup(), 0x0000));
+	}
+
+	if (!this->dirty.empty())
+	{
+		dataSet->computeGroupLengthAndPadding(EGL_recalcGL, EPD_noChange, xfer, EET_ExplicitLength);
+	}
+
+	// the target only changes once the copy is complete, a failed write leaves it as it was
+	const std::string partFileName = fileName + ".part";
+	OFFile out;
+
+	if (!out.fopen(partFileName.c_str(), "wb"))
+	{
+		return EC_InvalidStream;
+	}
+
+	OFCondition cond = copyRange(in, out, 0, metaEnd) ? EC_Normal : EC_InvalidStream;
+	std::vector<char> buffer;
+
+	for (unsigned long i = 0; i < dataSet->card() && cond.good(); i++)
+	{
+		DcmElement* element = dataSet->getElement(i);
+		const DcmTagKey tag = element->getTag().getBaseTag();
+		const auto range = ranges.find(tag);
+
+		if (range != ranges.end() && !encode.count(tag))
+		{
+			cond = copyRange(in, out, range->second.offset, range->second.length) ? EC_Normal : EC_InvalidStream;
+		}
+
+		else
+		{
+			cond = encodeElement(element, xfer, buffer);
+
+			if (cond.good() && out.fwrite(buffer.data(), 1, buffer.size()) != buffer.size())
+			{
+				cond = EC_InvalidStream;
+			}
+		}
+	}
+
+	if (out.fclose() != 0 && cond.good())
+	{
+		cond = EC_InvalidStream;
+	}
+
+	std::error_code error;
+
+	if (cond.good())
+	{
+		std::filesystem::rename(std::filesystem::u8path(partFileName), std::filesystem::u8path(fileName), error);
+
+		if (error)
+		{
+			cond = EC_InvalidStream;
+		}
+	}
+
+	if (cond.bad())
+	{
+		std::filesystem::remove(std::filesystem::u8path(partFileName), error);
+	}
+
+	return cond;
+}
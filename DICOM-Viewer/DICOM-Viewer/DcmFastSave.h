@@ -0,0 +1,43 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dctagkey.h"
+#include "dcmtk/ofstd/offile.h"
+
+class DcmFastSave
+{
+	public:
+		struct Range
+		{
+			offile_off_t offset = 0;
+			offile_off_t length = 0;
+		};
+
+		DcmFastSave() = default;
+		~DcmFastSave() = default;
+
+		void setSource(DcmFileFormat* file, const std::string& fileName);
+		void setRanges(const std::map<DcmTagKey, Range>& ranges, offile_off_t metaEnd);
+		void markDirty(const DcmTagKey& tag);
+		void clear();
+		bool isDirty() const;
+		OFCondition saveFile(const std::string& fileName);
+
+	private:
+		DcmFileFormat* file = nullptr;
+		std::string sourceFileName;
+		std::set<DcmTagKey> dirty;
+		std::map<DcmTagKey, Range> cachedRanges;
+		offile_off_t cachedMetaEnd = 0;
+
+		bool canSaveFast(const std::string& fileName) const;
+		static bool sameFile(const std::string& first, const std::string& second);
+		bool scanSource(std::map<DcmTagKey, Range>& ranges, offile_off_t& metaEnd) const;
+		OFCondition writeFast(OFFile& in, const std::string& fileName);
+		static bool copyRange(OFFile& in, OFFile& out, offile_off_t offset, offile_off_t length);
+		static OFCondition encodeElement(DcmObject* object, E_TransferSyntax xfer, std::vector<char>& buffer);
+};
@@ -0,0 +1,268 @@
+#include "DcmFolderWatcher.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+// events arrive in bursts while a modality writes a series, so changes are collected and handled together
+#define SETTLE_INTERVAL 1000
+// files the system refuses to watch, e.g. past the inotify limit, are compared by time this often instead
+#define SWEEP_INTERVAL 30000
+
+DcmFolderWatcher::DcmFolderWatcher(QObject* parent) : QObject(parent)
+{
+	this->timer.setSingleShot(true);
+	this->timer.setInterval(SETTLE_INTERVAL);
+	this->sweepTimer.setInterval(SWEEP_INTERVAL);
+	connect(&watcher, &QFileSystemWatcher::directoryChanged, this, &DcmFolderWatcher::directoryChanged);
+	connect(&watcher, &QFileSystemWatcher::fileChanged, this, &DcmFolderWatcher::fileChanged);
+	connect(&timer, &QTimer::timeout, this, &DcmFolderWatcher::flush);
+	connect(&sweepTimer, &QTimer::timeout, this, &DcmFolderWatcher::sweep);
+}
+
+//========================================================================================================================
+void DcmFolderWatcher::watch(const QString& folder)
+{
+	this->stop();
+	this->addDirectory(QDir(folder).absolutePath(), false);
+}
+
+//========================================================================================================================
+void DcmFolderWatcher::stop()
+{
+	this->timer.stop();
+	this->sweepTimer.stop();
+
+	if (!this->watcher.directories().empty())
+	{
+		this->watcher.removePaths(this->watcher.directories());
+	}
+
+	if (!this->watcher.files().empty())
+	{
+		this->watcher.removePaths(this->watcher.files());
+	}
+
+	this->dirty.clear();
+	this->unwatched.clear();
+	this->snapshot.clear();
+	this->settling.clear();
+}
+
+//========================================================================================================================
+bool DcmFolderWatcher::isWatching() const
+{
+	return !this->snapshot.empty();
+}
+
+//========================================================================================================================
+void DcmFolderWatcher::addDirectory(const QString& path, const bool report)
+{
+	QHash<QString, qint64> files;
+	QStringList paths;
+	this->watcher.addPath(path);
+
+	for (const auto& info : QDir(path).entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot))
+	{
+		if (info.isDir())
+		{
+			this->addDirectory(info.absoluteFilePath(), report);
+			continue;
+		}
+
+		files.insert(info.fileName(), info.lastModified().toMSecsSinceEpoch());
+		paths.append(info.absoluteFilePath());
+
+		if (report)
+		{
+			this->settling.insert(info.absoluteFilePath(), Stamp());
+		}
+	}
+
+	this->snapshot.insert(path, files);
+	this->watchFiles(paths);
+}
+
+//========================================================================================================================
+void DcmFolderWatcher::watchFiles(const QStringList& files)
+{
+	if (files.empty())
+	{
+		return;
+	}
+
+	// a file rewritten in place changes no directory entry, so every file is watched on its own
+	for (const auto& file : this->watcher.addPaths(files))
+	{
+		this->unwatched.insert(file);
+	}
+
+	if (!this->unwatched.empty() && !this->sweepTimer.isActive())
+	{
+		this->sweepTimer.start();
+	}
+}
+
+//========================================================================================================================
+void DcmFolderWatcher::rescanDirectory(const QString& path, QStringList& removed)
+{
+	const QDir directory(path);
+
+	if (!directory.exists())
+	{
+		const QString prefix = path + '/';
+
+		for (auto it = this->snapshot.begin(); it != this->snapshot.end();)
+		{
+			if (it.key() == path || it.key().startsWith(prefix))
+			{
+				for (auto file = it.value().constBegin(); file != it.value().constEnd(); ++file)
+				{
+					removed.append(QDir(it.key()).filePath(file.key()));
+					this->unwatched.remove(removed.back());
+				}
+
+				this->watcher.removePath(it.key());
+				it = this->snapshot.erase(it);
+			}
+
+			else
+			{
+				++it;
+			}
+		}
+
+		return;
+	}
+
+	QHash<QString, qint64> current;
+	QStringList added;
+
+	for (const auto& info : directory.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot))
+	{
+		if (info.isDir())
+		{
+			if (!this->snapshot.contains(info.absoluteFilePath()))
+			{
+				this->addDirectory(info.absoluteFilePath(), true);
+			}
+
+			continue;
+		}
+
+		const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+		const auto known = this->snapshot[path].constFind(info.fileName());
+
+		if (known == this->snapshot[path].constEnd())
+		{
+			added.append(info.absoluteFilePath());
+		}
+
+		if (known == this->snapshot[path].constEnd() || known.value() != modified)
+		{
+			this->settling.insert(info.absoluteFilePath(), Stamp());
+		}
+
+		current.insert(info.fileName(), modified);
+	}
+
+	for (auto file = this->snapshot[path].constBegin(); file != this->snapshot[path].constEnd(); ++file)
+	{
+		if (!current.contains(file.key()))
+		{
+			removed.append(directory.filePath(file.key()));
+			this->unwatched.remove(removed.back());
+		}
+	}
+
+	this->snapshot[path] = current;
+	this->watchFiles(added);
+}
+
+//========================================================================================================================
+void DcmFolderWatcher::directoryChanged(const QString& path)
+{
+	this->dirty.insert(path);
+	this->timer.start();
+}
+
+//========================================================================================================================
+void DcmFolderWatcher::fileChanged(const QString& path)
+{
+	const QFileInfo info(path);
+
+	// a file replaced by a rename loses its watch, so it is watched again
+	if (info.exists() && !this->watcher.files().contains(path) && !this->watcher.addPath(path))
+	{
+		this->unwatched.insert(path);
+
+		if (!this->sweepTimer.isActive())
+		{
+			this->sweepTimer.start();
+		}
+	}
+
+	this->dirty.insert(info.absolutePath());
+	this->timer.start();
+}
+
+//========================================================================================================================
+void DcmFolderWatcher::sweep()
+{
+	if (this->unwatched.empty())
+	{
+		this->sweepTimer.stop();
+		return;
+	}
+
+	// rescanning compares modification times, so unwatched files rewritten in place are still picked up
+	for (const auto& file : this->unwatched)
+	{
+		this->dirty.insert(QFileInfo(file).absolutePath());
+	}
+
+	this->timer.start();
+}
+
+//========================================================================================================================
+void DcmFolderWatcher::flush()
+{
+	QStringList files;
+
+	for (const auto& path : this->dirty)
+	{
+		this->rescanDirectory(path, files);
+	}
+
+	this->dirty.clear();
+
+	// a file is only reported once its size and time stop moving, so half written files are not parsed
+	for (auto it = this->settling.begin(); it != this->settling.end();)
+	{
+		const QFileInfo info(it.key());
+		const qint64 size = info.exists() ? info.size() : -1;
+		const qint64 modified = info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+
+		if (!info.exists() || (it.value().size == size && it.value().modified == modified))
+		{
+			files.append(it.key());
+			it = this->settling.erase(it);
+		}
+
+		else
+		{
+			it.value().size = size;
+			it.value().modified = modified;
+			++it;
+		}
+	}
+
+	if (!this->settling.empty())
+	{
+		this->timer.start();
+	}
+
+	if (!files.empty())
+	{
+		emit filesChanged(files);
+	}
+}
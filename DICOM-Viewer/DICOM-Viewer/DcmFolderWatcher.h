@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+class DcmFolderWatcher final : public QObject
+{
+	Q_OBJECT
+
+	public:
+		explicit DcmFolderWatcher(QObject* parent = nullptr);
+		~DcmFolderWatcher() = default;
+
+		void watch(const QString& folder);
+		void stop();
+		bool isWatching() const;
+
+	signals:
+		void filesChanged(const QStringList& files);
+
+	private:
+		struct Stamp
+		{
+			qint64 size = -1;
+			qint64 modified = -1;
+		};
+
+		QFileSystemWatcher watcher;
+		QTimer timer;
+		QTimer sweepTimer;
+		QSet<QString> dirty;
+		QSet<QString> unwatched;
+		QHash<QString, QHash<QString, qint64>> snapshot;
+		QHash<QString, Stamp> settling;
+
+		void addDirectory(const QString& path, bool report);
+		void rescanDirectory(const QString& path, QStringList& removed);
+		void watchFiles(const QStringList& files);
+
+	private slots:
+		void directoryChanged(const QString& path);
+		void fileChanged(const QString& path);
+		void sweep();
+		void flush();
+};
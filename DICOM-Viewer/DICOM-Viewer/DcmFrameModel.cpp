@@ -0,0 +1,150 @@
+#include "DcmFrameModel.h"
+#include <QFont>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+DcmFrameModel::DcmFrameModel(QObject* parent) : QAbstractTableModel(parent)
+{
+}
+
+//========================================================================================================================
+void DcmFrameModel::setTable(DcmFrameTable&& table)
+{
+	this->beginResetModel();
+	this->table = std::move(table);
+	this->order.resize(this->table.getFrameCount());
+	std::iota(this->order.begin(), this->order.end(), 0);
+	this->rows = this->order;
+	this->endResetModel();
+}
+
+//========================================================================================================================
+const DcmFrameTable& DcmFrameModel::getTable() const
+{
+	return this->table;
+}
+
+//========================================================================================================================
+int DcmFrameModel::rowOfFrame(const int frame) const
+{
+	return frame >= 0 && frame < static_cast<int>(this->rows.size()) ? this->rows[frame] : -1;
+}
+
+//========================================================================================================================
+int DcmFrameModel::rowCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : this->table.getFrameCount();
+}
+
+//========================================================================================================================
+int DcmFrameModel::columnCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : this->table.getColumnCount();
+}
+
+//========================================================================================================================
+QVariant DcmFrameModel::data(const QModelIndex& index, const int role) const
+{
+	if (!index.isValid())
+	{
+		return QVariant();
+	}
+
+	const DcmFrameTable::Column& column = this->table.getColumn(index.column());
+
+	if (role == Qt::DisplayRole)
+	{
+		return column.text[this->order[index.row()]];
+	}
+
+	if (role == Qt::TextAlignmentRole && column.numeric)
+	{
+		return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+	}
+
+	return QVariant();
+}
+
+//========================================================================================================================
+QVariant DcmFrameModel::headerData(const int section, const Qt::Orientation orientation, const int role) const
+{
+	if (orientation == Qt::Vertical)
+	{
+		return role == Qt::DisplayRole ? QVariant(this->order[section] + 1) : QVariant();
+	}
+
+	if (role == Qt::FontRole)
+	{
+		QFont font;
+		font.setBold(true);
+		return font;
+	}
+
+	return role == Qt::DisplayRole ? QVariant(this->table.getColumn(section).name) : QVariant();
+}
+
+//========================================================================================================================
+void DcmFrameModel::sort(const int column, const Qt::SortOrder order)
+{
+	if (column < 0 || column >= this->table.getColumnCount())
+	{
+		return;
+	}
+
+	emit layoutAboutToBeChanged();
+	const QModelIndexList persistent = this->persistentIndexList();
+	std::vector<int> persistentFrames;
+
+	for (const QModelIndex& index : persistent)
+	{
+		persistentFrames.push_back(this->order[index.row()]);
+	}
+
+	const DcmFrameTable::Column& values = this->table.getColumn(column);
+	const bool ascending = order == Qt::AscendingOrder;
+
+	// frames are sorted as indices into the column, frames without a value stay at the end either way
+	if (values.numeric)
+	{
+		const std::vector<double>& numbers = values.numbers;
+		std::stable_sort(this->order.begin(), this->order.end(), [&numbers, ascending](const int first, const int second)
+		{
+			if (std::isnan(numbers[first]) || std::isnan(numbers[second]))
+			{
+				return !std::isnan(numbers[first]) && std::isnan(numbers[second]);
+			}
+
+			return ascending ? numbers[first] < numbers[second] : numbers[second] < numbers[first];
+		});
+	}
+
+	else
+	{
+		const std::vector<QString>& text = values.text;
+		std::stable_sort(this->order.begin(), this->order.end(), [&text, ascending](const int first, const int second)
+		{
+			if (text[first].isEmpty() || text[second].isEmpty())
+			{
+				return !text[first].isEmpty() && text[second].isEmpty();
+			}
+
+			return ascending ? text[first] < text[second] : text[second] < text[first];
+		});
+	}
+
+	for (int row = 0; row < static_cast<int>(this->order.size()); row++)
+	{
+		this->rows[this->order[row]] = row;
+	}
+
+	QModelIndexList moved;
+
+	for (int i = 0; i < persistent.size(); i++)
+	{
+		moved.append(this->index(this->rows[persistentFrames[i]], persistent[i].column()));
+	}
+
+	this->changePersistentIndexList(persistent, moved);
+	emit layoutChanged();
+}
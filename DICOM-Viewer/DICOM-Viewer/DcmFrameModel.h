@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <vector>
+#include "DcmFrameTable.h"
+
+class DcmFrameModel final : public QAbstractTableModel
+{
+	Q_OBJECT
+
+	public:
+		explicit DcmFrameModel(QObject* parent = nullptr);
+		void setTable(DcmFrameTable&& table);
+		const DcmFrameTable& getTable() const;
+		int rowOfFrame(int frame) const;
+		int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+		int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+		QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+		QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+		void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+	private:
+		DcmFrameTable table;
+		std::vector<int> order;
+		std::vector<int> rows;
+};
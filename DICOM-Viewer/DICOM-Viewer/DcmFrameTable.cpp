@@ -0,0 +1,287 @@
+#include "DcmFrameTable.h"
+#include <cmath>
+#include <limits>
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcsequen.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRAME_SSE2
+#endif
+
+static bool isNumeric(const DcmEVR vr)
+{
+	switch (vr)
+	{
+		case EVR_DS: case EVR_IS: case EVR_FD: case EVR_FL: case EVR_US: case EVR_SS: case EVR_UL: case EVR_SL:
+			return true;
+		default:
+			return false;
+	}
+}
+
+//========================================================================================================================
+bool DcmFrameTable::build(DcmDataset* dataset, QString& error)
+{
+	this->clear();
+	DcmSequenceOfItems* perFrame = nullptr;
+
+	if (dataset->findAndGetSequence(DCM_PerFrameFunctionalGroupsSequence, perFrame).bad() || !perFrame || perFrame->card() == 0)
+	{
+		error = "The file has no Per-frame Functional Groups Sequence!";
+		return false;
+	}
+
+	this->frames = static_cast<int>(perFrame->card());
+	DcmItem* shared = nullptr;
+	double sharedOrientation[6] = { 1, 0, 0, 0, 1, 0 };
+	bool hasSharedOrientation = false;
+
+	if (dataset->findAndGetSequenceItem(DCM_SharedFunctionalGroupsSequence, shared).good() && shared)
+	{
+		hasSharedOrientation = getOrientation(shared, sharedOrientation);
+	}
+
+	// slice position is derived from the plane position and orientation and kept as the first column
+	Column slice;
+	slice.name = "Slice Position";
+	slice.numeric = true;
+	slice.text.resize(this->frames);
+	slice.numbers.assign(this->frames, std::numeric_limits<double>::quiet_NaN());
+	this->columns.push_back(std::move(slice));
+
+	std::map<std::vector<Uint32>, int> index;
+	std::vector<Uint32> path;
+	DcmObject* object = nullptr;
+
+	for (int frame = 0; frame < this->frames; frame++)
+	{
+		object = perFrame->nextInContainer(object);
+		auto* item = OFstatic_cast(DcmItem*, object);
+		this->addItem(item, frame, path, index);
+
+		DcmItem* plane = nullptr;
+		Float64 position[3];
+
+		if (item->findAndGetSequenceItem(DCM_PlanePositionSequence, plane).bad() || !plane
+			|| plane->findAndGetFloat64(DCM_ImagePositionPatient, position[0], 0).bad()
+			|| plane->findAndGetFloat64(DCM_ImagePositionPatient, position[1], 1).bad()
+			|| plane->findAndGetFloat64(DCM_ImagePositionPatient, position[2], 2).bad())
+		{
+			continue;
+		}
+
+		double orientation[6] = { sharedOrientation[0], sharedOrientation[1], sharedOrientation[2], sharedOrientation[3], sharedOrientation[4], sharedOrientation[5] };
+		const bool hasOrientation = getOrientation(item, orientation) || hasSharedOrientation;
+		const double normal[3] = {
+			orientation[1] * orientation[5] - orientation[2] * orientation[4],
+			orientation[2] * orientation[3] - orientation[0] * orientation[5],
+			orientation[0] * orientation[4] - orientation[1] * orientation[3] };
+		const double distance = hasOrientation ? position[0] * normal[0] + position[1] * normal[1] + position[2] * normal[2] : position[2];
+
+		this->columns[0].numbers[frame] = distance;
+		this->columns[0].text[frame] = QString::number(distance, 'f', 4);
+		this->slicePosition = true;
+	}
+
+	if (!this->slicePosition)
+	{
+		this->columns.erase(this->columns.begin());
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+void DcmFrameTable::addItem(DcmItem* item, const int frame, std::vector<Uint32>& path, std::map<std::vector<Uint32>, int>& index)
+{
+	for (DcmObject* object = item->nextInContainer(nullptr); object; object = item->nextInContainer(object))
+	{
+		auto* element = OFstatic_cast(DcmElement*, object);
+		const DcmTagKey tag = element->getTag().getBaseTag();
+		path.push_back(OFstatic_cast(Uint32, tag.getGroup()) << 16 | tag.getElement());
+
+		if (element->ident() == EVR_SQ)
+		{
+			// functional group macros hold a single item, further items would map onto the same columns
+			DcmItem* nested = OFstatic_cast(DcmSequenceOfItems*, element)->getItem(0);
+
+			if (nested)
+			{
+				this->addItem(nested, frame, path, index);
+			}
+		}
+
+		else
+		{
+			Column& column = this->columns[this->columnFor(path, element, index)];
+			OFString value;
+			element->getOFStringArray(value);
+			column.text[frame] = QString::fromLatin1(value.c_str());
+
+			if (column.numeric)
+			{
+				bool ok = false;
+				const double number = column.text[frame].section('\\', 0, 0).trimmed().toDouble(&ok);
+				column.numbers[frame] = ok ? number : std::numeric_limits<double>::quiet_NaN();
+			}
+		}
+
+		path.pop_back();
+	}
+}
+
+//========================================================================================================================
+int DcmFrameTable::columnFor(const std::vector<Uint32>& path, DcmElement* element, std::map<std::vector<Uint32>, int>& index)
+{
+	const auto found = index.find(path);
+
+	if (found != index.end())
+	{
+		return found->second;
+	}
+
+	Column column;
+
+	for (const Uint32 key : path)
+	{
+		column.name += (column.name.isEmpty() ? "" : " > ") + QString(DcmTag(DcmTagKey(OFstatic_cast(Uint16, key >> 16), OFstatic_cast(Uint16, key & 0xFFFF))).getTagName());
+	}
+
+	column.numeric = isNumeric(element->ident());
+	column.text.resize(this->frames);
+
+	if (column.numeric)
+	{
+		column.numbers.assign(this->frames, std::numeric_limits<double>::quiet_NaN());
+	}
+
+	this->columns.push_back(std::move(column));
+	const int position = static_cast<int>(this->columns.size()) - 1;
+	index.emplace(path, position);
+	return position;
+}
+
+//========================================================================================================================
+bool DcmFrameTable::getOrientation(DcmItem* item, double* orientation)
+{
+	DcmItem* plane = nullptr;
+
+	if (item->findAndGetSequenceItem(DCM_PlaneOrientationSequence, plane).bad() || !plane)
+	{
+		return false;
+	}
+
+	for (unsigned long i = 0; i < 6; i++)
+	{
+		Float64 value = 0;
+
+		if (plane->findAndGetFloat64(DCM_ImageOrientationPatient, value, i).bad())
+		{
+			return false;
+		}
+
+		orientation[i] = value;
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+void DcmFrameTable::clear()
+{
+	this->columns.clear();
+	this->frames = 0;
+	this->slicePosition = false;
+}
+
+//========================================================================================================================
+int DcmFrameTable::getFrameCount() const
+{
+	return this->frames;
+}
+
+//========================================================================================================================
+int DcmFrameTable::getColumnCount() const
+{
+	return static_cast<int>(this->columns.size());
+}
+
+//========================================================================================================================
+const DcmFrameTable::Column& DcmFrameTable::getColumn(const int column) const
+{
+	return this->columns[column];
+}
+
+//========================================================================================================================
+bool DcmFrameTable::hasSlicePosition() const
+{
+	return this->slicePosition;
+}
+
+//========================================================================================================================
+int DcmFrameTable::findNearestFrame(const double position) const
+{
+	if (!this->slicePosition)
+	{
+		return -1;
+	}
+
+	const double* values = this->columns[0].numbers.data();
+	const size_t count = this->columns[0].numbers.size();
+	double best = std::numeric_limits<double>::infinity();
+	int bestFrame = -1;
+	size_t i = 0;
+
+#ifdef FRAME_SSE2
+	// two frames per step, each lane keeps its own closest distance and frame, frames without a position are NaN and never win
+	const __m128d target = _mm_set1_pd(position);
+	const __m128d sign = _mm_set1_pd(-0.0);
+	const __m128d step = _mm_set1_pd(2.0);
+	__m128d laneBest = _mm_set1_pd(best);
+	__m128d laneFrame = _mm_set1_pd(-1.0);
+	__m128d frame = _mm_set_pd(1.0, 0.0);
+
+	for (; i + 2 <= count; i += 2)
+	{
+		const __m128d distance = _mm_andnot_pd(sign, _mm_sub_pd(_mm_loadu_pd(values + i), target));
+		const __m128d closer = _mm_cmplt_pd(distance, laneBest);
+		laneBest = _mm_or_pd(_mm_and_pd(closer, distance), _mm_andnot_pd(closer, laneBest));
+		laneFrame = _mm_or_pd(_mm_and_pd(closer, frame), _mm_andnot_pd(closer, laneFrame));
+		frame = _mm_add_pd(frame, step);
+	}
+
+	alignas(16) double bestLanes[2];
+	alignas(16) double frameLanes[2];
+	_mm_store_pd(bestLanes, laneBest);
+	_mm_store_pd(frameLanes, laneFrame);
+
+	for (int lane = 0; lane < 2; lane++)
+	{
+		if (frameLanes[lane] >= 0 && (bestLanes[lane] < best || (bestLanes[lane] == best && frameLanes[lane] < bestFrame)))
+		{
+			best = bestLanes[lane];
+			bestFrame = static_cast<int>(frameLanes[lane]);
+		}
+	}
+#endif
+
+	return nearestScalar(values, i, count, position, best, bestFrame);
+}
+
+//========================================================================================================================
+int DcmFrameTable::nearestScalar(const double* values, const size_t from, const size_t count, const double position, double& best, int bestFrame)
+{
+	for (size_t i = from; i < count; i++)
+	{
+		const double distance = std::fabs(values[i] - position);
+
+		if (distance < best)
+		{
+			best = distance;
+			bestFrame = static_cast<int>(i);
+		}
+	}
+
+	return bestFrame;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QString>
+#include <map>
+#include <vector>
+#include "dcmtk/dcmdata/dcdatset.h"
+
+class DcmFrameTable
+{
+	public:
+		struct Column
+		{
+			QString name;
+			std::vector<QString> text;
+			std::vector<double> numbers;
+			bool numeric = false;
+		};
+
+		bool build(DcmDataset* dataset, QString& error);
+		void clear();
+		int getFrameCount() const;
+		int getColumnCount() const;
+		const Column& getColumn(int column) const;
+		bool hasSlicePosition() const;
+		int findNearestFrame(double position) const;
+
+	private:
+		std::vector<Column> columns;
+		int frames = 0;
+		bool slicePosition = false;
+		int columnFor(const std::vector<Uint32>& path, DcmElement* element, std::map<std::vector<Uint32>, int>& index);
+		void addItem(DcmItem* item, int frame, std::vector<Uint32>& path, std::map<std::vector<Uint32>, int>& index);
+		static bool getOrientation(DcmItem* item, double* orientation);
+		static int nearestScalar(const double* values, size_t from, size_t count, double position, double& best, int bestFrame);
+};
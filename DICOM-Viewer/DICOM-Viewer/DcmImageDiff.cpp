@@ -0,0 +1,455 @@
+#include "DcmImageDiff.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcrledrg.h"
+#include "dcmtk/dcmimage/diregist.h"
+#include "dcmtk/dcmimgle/dcmimage.h"
+#include "dcmtk/dcmimgle/dipixel.h"
+#include "dcmtk/dcmjpeg/djdecode.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DIFF_SSE2
+#endif
+
+// lane sums are flushed to 64 bit after this many vectors, well before a 32 bit lane can overflow
+#define FLUSH_BLOCK 16384
+
+template <typename T>
+static void diffScalar(const T* first, const T* second, const size_t count, DcmImageDiff::Stats& stats)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		const Uint64 diff = first[i] > second[i] ? OFstatic_cast(Uint64, first[i]) - second[i] : OFstatic_cast(Uint64, second[i]) - first[i];
+		stats.maxError = std::max(stats.maxError, OFstatic_cast(Uint32, std::min<Uint64>(diff, 0xFFFFFFFF)));
+		stats.sum += diff;
+		stats.sumSquares += diff * diff;
+		stats.differing += diff != 0;
+	}
+
+	stats.count += count;
+}
+
+template <typename T>
+static void absoluteDiff(const T* first, const T* second, const size_t count, std::vector<Uint32>& out)
+{
+	out.resize(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = first[i] > second[i] ? OFstatic_cast(Uint32, first[i] - second[i]) : OFstatic_cast(Uint32, second[i] - first[i]);
+	}
+}
+
+//========================================================================================================================
+void DcmImageDiff::Stats::merge(const Stats& other)
+{
+	this->maxError = std::max(this->maxError, other.maxError);
+	this->sum += other.sum;
+	this->sumSquares += other.sumSquares;
+	this->differing += other.differing;
+	this->count += other.count;
+}
+
+//========================================================================================================================
+double DcmImageDiff::Stats::meanError() const
+{
+	return this->count ? OFstatic_cast(double, this->sum) / this->count : 0;
+}
+
+//========================================================================================================================
+double DcmImageDiff::Stats::psnr(const double peak) const
+{
+	const double mse = this->count ? OFstatic_cast(double, this->sumSquares) / this->count : 0;
+	return mse > 0 ? 10 * std::log10(peak * peak / mse) : std::numeric_limits<double>::infinity();
+}
+
+//========================================================================================================================
+DcmImageDiff::DcmImageDiff()
+{
+	registerCodecs();
+}
+
+//========================================================================================================================
+DcmImageDiff::~DcmImageDiff() = default;
+
+//========================================================================================================================
+void DcmImageDiff::registerCodecs()
+{
+	static std::once_flag once;
+
+	std::call_once(once, []()
+	{
+		DJDecoderRegistration::registerCodecs();
+		DcmRLEDecoderRegistration::registerCodecs();
+	});
+}
+
+//========================================================================================================================
+bool DcmImageDiff::open(DcmFileFormat* first, DcmFileFormat* second, QString& error)
+{
+	DcmDataset* dataSets[2] = { first->getDataset(), second->getDataset() };
+
+	if (!dataSets[0]->tagExists(DCM_PixelData) || !dataSets[1]->tagExists(DCM_PixelData))
+	{
+		error = "Both files must contain pixel data!";
+		return false;
+	}
+
+	// the files belong to the compare dialog, decoding works on copies so their pixel data is never detached or converted
+	DcmDataset* copies[2] = { OFstatic_cast(DcmDataset*, dataSets[0]->clone()), OFstatic_cast(DcmDataset*, dataSets[1]->clone()) };
+	this->first.reset(new DicomImage(copies[0], dataSets[0]->getOriginalXfer(), CIF_MayDetachPixelData | CIF_TakeOverExternalDataset));
+	this->second.reset(new DicomImage(copies[1], dataSets[1]->getOriginalXfer(), CIF_MayDetachPixelData | CIF_TakeOverExternalDataset));
+
+	for (const auto* image : { this->first.get(), this->second.get() })
+	{
+		if (image->getStatus() != EIS_Normal)
+		{
+			error = QString("Failed to decode pixel data: ") + DicomImage::getString(image->getStatus());
+			return false;
+		}
+	}
+
+	if (this->first->getWidth() != this->second->getWidth() || this->first->getHeight() != this->second->getHeight()
+		|| this->first->getFrameCount() != this->second->getFrameCount() || this->first->isMonochrome() != this->second->isMonochrome())
+	{
+		error = "Images differ in size, frame count or color model!";
+		return false;
+	}
+
+	this->width = this->first->getWidth();
+	this->height = this->first->getHeight();
+	this->frames = this->first->getFrameCount();
+	this->color = !this->first->isMonochrome();
+
+	Uint16 bitsStored = 0;
+	dataSets[0]->findAndGetUint16(DCM_BitsStored, bitsStored);
+	this->peak = this->color ? 255.0 : std::pow(2.0, bitsStored ? bitsStored : this->first->getDepth()) - 1;
+
+	if (!this->color && this->first->getInterData()->getRepresentation() != this->second->getInterData()->getRepresentation())
+	{
+		error = "Images use different pixel representations!";
+		return false;
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+unsigned long DcmImageDiff::getFrameCount() const
+{
+	return this->frames;
+}
+
+//========================================================================================================================
+unsigned long DcmImageDiff::getWidth() const
+{
+	return this->width;
+}
+
+//========================================================================================================================
+unsigned long DcmImageDiff::getHeight() const
+{
+	return this->height;
+}
+
+//========================================================================================================================
+double DcmImageDiff::getPeak() const
+{
+	return this->peak;
+}
+
+//========================================================================================================================
+bool DcmImageDiff::framePointers(const unsigned long frame, const void*& firstData, const void*& secondData, int& representation, size_t& count)
+{
+	if (frame >= this->frames)
+	{
+		return false;
+	}
+
+	count = OFstatic_cast(size_t, this->width) * this->height;
+
+	// color frames are compared after rendering to 8 bit RGB, monochrome ones on the modality values
+	if (this->color)
+	{
+		count *= 3;
+		representation = EPR_Uint8;
+		firstData = this->first->getOutputData(8, frame, 0);
+		secondData = this->second->getOutputData(8, frame, 0);
+		return firstData && secondData;
+	}
+
+	const DiPixel* firstPixel = this->first->getInterData();
+	const DiPixel* secondPixel = this->second->getInterData();
+	representation = firstPixel->getRepresentation();
+	const size_t offset = count * frame;
+
+	switch (representation)
+	{
+		case EPR_Uint8:
+		case EPR_Sint8:
+			firstData = OFstatic_cast(const Uint8*, firstPixel->getData()) + offset;
+			secondData = OFstatic_cast(const Uint8*, secondPixel->getData()) + offset;
+			break;
+
+		case EPR_Uint16:
+		case EPR_Sint16:
+			firstData = OFstatic_cast(const Uint16*, firstPixel->getData()) + offset;
+			secondData = OFstatic_cast(const Uint16*, secondPixel->getData()) + offset;
+			break;
+
+		default:
+			firstData = OFstatic_cast(const Uint32*, firstPixel->getData()) + offset;
+			secondData = OFstatic_cast(const Uint32*, secondPixel->getData()) + offset;
+			break;
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+bool DcmImageDiff::compareFrame(const unsigned long frame, Stats& stats)
+{
+	const void* firstData = nullptr;
+	const void* secondData = nullptr;
+	int representation = EPR_Uint8;
+	size_t count = 0;
+
+	if (!this->framePointers(frame, firstData, secondData, representation, count))
+	{
+		return false;
+	}
+
+	switch (representation)
+	{
+		case EPR_Uint8:
+		case EPR_Sint8:
+			diffUint8(OFstatic_cast(const Uint8*, firstData), OFstatic_cast(const Uint8*, secondData), count, representation == EPR_Sint8 ? 0x80 : 0, stats);
+			break;
+
+		case EPR_Uint16:
+		case EPR_Sint16:
+			diffUint16(OFstatic_cast(const Uint16*, firstData), OFstatic_cast(const Uint16*, secondData), count, representation == EPR_Sint16 ? 0x8000 : 0, stats);
+			break;
+
+		case EPR_Sint32:
+			diffScalar(OFstatic_cast(const Sint32*, firstData), OFstatic_cast(const Sint32*, secondData), count, stats);
+			break;
+
+		default:
+			diffScalar(OFstatic_cast(const Uint32*, firstData), OFstatic_cast(const Uint32*, secondData), count, stats);
+			break;
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+bool DcmImageDiff::heatMap(const unsigned long frame, QImage& image)
+{
+	const void* firstData = nullptr;
+	const void* secondData = nullptr;
+	int representation = EPR_Uint8;
+	size_t count = 0;
+	std::vector<Uint32> diff;
+
+	if (!this->framePointers(frame, firstData, secondData, representation, count))
+	{
+		return false;
+	}
+
+	switch (representation)
+	{
+		case EPR_Uint8:
+			absoluteDiff(OFstatic_cast(const Uint8*, firstData), OFstatic_cast(const Uint8*, secondData), count, diff);
+			break;
+		case EPR_Sint8:
+			absoluteDiff(OFstatic_cast(const Sint8*, firstData), OFstatic_cast(const Sint8*, secondData), count, diff);
+			break;
+		case EPR_Uint16:
+			absoluteDiff(OFstatic_cast(const Uint16*, firstData), OFstatic_cast(const Uint16*, secondData), count, diff);
+			break;
+		case EPR_Sint16:
+			absoluteDiff(OFstatic_cast(const Sint16*, firstData), OFstatic_cast(const Sint16*, secondData), count, diff);
+			break;
+		case EPR_Sint32:
+			absoluteDiff(OFstatic_cast(const Sint32*, firstData), OFstatic_cast(const Sint32*, secondData), count, diff);
+			break;
+		default:
+			absoluteDiff(OFstatic_cast(const Uint32*, firstData), OFstatic_cast(const Uint32*, secondData), count, diff);
+			break;
+	}
+
+	const size_t samples = this->color ? 3 : 1;
+	Uint32 maximum = 1;
+
+	for (const auto value : diff)
+	{
+		maximum = std::max(maximum, value);
+	}
+
+	image = QImage(OFstatic_cast(int, this->width), OFstatic_cast(int, this->height), QImage::Format_RGB32);
+
+	// black through red and yellow to white, scaled to the largest error in the frame
+	for (unsigned long y = 0; y < this->height; y++)
+	{
+		auto* line = reinterpret_cast<QRgb*>(image.scanLine(OFstatic_cast(int, y)));
+
+		for (unsigned long x = 0; x < this->width; x++)
+		{
+			const size_t index = (OFstatic_cast(size_t, y) * this->width + x) * samples;
+			Uint32 value = diff[index];
+
+			for (size_t sample = 1; sample < samples; sample++)
+			{
+				value = std::max(value, diff[index + sample]);
+			}
+
+			const int level = OFstatic_cast(int, 765.0 * value / maximum);
+			line[x] = qRgb(std::min(level, 255), std::max(0, std::min(level - 255, 255)), std::max(0, level - 510));
+		}
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+void DcmImageDiff::diffUint8(const Uint8* first, const Uint8* second, const size_t count, const Uint8 bias, Stats& stats)
+{
+	size_t i = 0;
+
+#ifdef DIFF_SSE2
+	const __m128i flip = _mm_set1_epi8(OFstatic_cast(char, bias));
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi8(1);
+	__m128i maximum = zero;
+	__m128i sum = zero;
+	__m128i same = zero;
+	__m128i squares = zero;
+
+	while (i + 16 <= count)
+	{
+		const size_t end = i + std::min<size_t>((count - i) / 16, FLUSH_BLOCK) * 16;
+		__m128i squares32 = zero;
+
+		for (; i < end; i += 16)
+		{
+			const __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i)), flip);
+			const __m128i y = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(second + i)), flip);
+			const __m128i diff = _mm_or_si128(_mm_subs_epu8(x, y), _mm_subs_epu8(y, x));
+			const __m128i low = _mm_unpacklo_epi8(diff, zero);
+			const __m128i high = _mm_unpackhi_epi8(diff, zero);
+			maximum = _mm_max_epu8(maximum, diff);
+			sum = _mm_add_epi64(sum, _mm_sad_epu8(diff, zero));
+			same = _mm_add_epi64(same, _mm_sad_epu8(_mm_and_si128(_mm_cmpeq_epi8(diff, zero), one), zero));
+			squares32 = _mm_add_epi32(squares32, _mm_add_epi32(_mm_madd_epi16(low, low), _mm_madd_epi16(high, high)));
+		}
+
+		squares = _mm_add_epi64(squares, _mm_add_epi64(_mm_unpacklo_epi32(squares32, zero), _mm_unpackhi_epi32(squares32, zero)));
+	}
+
+	alignas(16) Uint8 maximumLanes[16];
+	alignas(16) Uint64 lanes[2];
+	_mm_store_si128(reinterpret_cast<__m128i*>(maximumLanes), maximum);
+
+	for (const auto lane : maximumLanes)
+	{
+		stats.maxError = std::max<Uint32>(stats.maxError, lane);
+	}
+
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), sum);
+	stats.sum += lanes[0] + lanes[1];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), squares);
+	stats.sumSquares += lanes[0] + lanes[1];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), same);
+	stats.differing += i - (lanes[0] + lanes[1]);
+	stats.count += i;
+#endif
+
+	if (bias)
+	{
+		diffScalar(reinterpret_cast<const Sint8*>(first + i), reinterpret_cast<const Sint8*>(second + i), count - i, stats);
+	}
+
+	else
+	{
+		diffScalar(first + i, second + i, count - i, stats);
+	}
+}
+
+//========================================================================================================================
+void DcmImageDiff::diffUint16(const Uint16* first, const Uint16* second, const size_t count, const Uint16 bias, Stats& stats)
+{
+	size_t i = 0;
+
+#ifdef DIFF_SSE2
+	// flipping the sign bit maps signed samples onto unsigned ones with the same ordering and distances
+	const __m128i flip = _mm_set1_epi16(OFstatic_cast(short, bias));
+	const __m128i zero = _mm_setzero_si128();
+	__m128i maximum = zero;
+	__m128i sum = zero;
+	__m128i squares = zero;
+	Uint64 same = 0;
+
+	while (i + 8 <= count)
+	{
+		const size_t end = i + std::min<size_t>((count - i) / 8, FLUSH_BLOCK) * 8;
+		__m128i sum32 = zero;
+		__m128i same16 = zero;
+
+		for (; i < end; i += 8)
+		{
+			const __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i)), flip);
+			const __m128i y = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(second + i)), flip);
+			const __m128i diff = _mm_or_si128(_mm_subs_epu16(x, y), _mm_subs_epu16(y, x));
+			const __m128i low = _mm_unpacklo_epi16(diff, zero);
+			const __m128i high = _mm_unpackhi_epi16(diff, zero);
+
+			// SSE2 has no unsigned 16 bit max, max(a, b) = (a - b saturated) + b
+			maximum = _mm_add_epi16(_mm_subs_epu16(maximum, diff), diff);
+			sum32 = _mm_add_epi32(sum32, _mm_add_epi32(low, high));
+			same16 = _mm_sub_epi16(same16, _mm_cmpeq_epi16(diff, zero));
+			squares = _mm_add_epi64(squares, _mm_add_epi64(_mm_mul_epu32(low, low), _mm_mul_epu32(_mm_srli_epi64(low, 32), _mm_srli_epi64(low, 32))));
+			squares = _mm_add_epi64(squares, _mm_add_epi64(_mm_mul_epu32(high, high), _mm_mul_epu32(_mm_srli_epi64(high, 32), _mm_srli_epi64(high, 32))));
+		}
+
+		sum = _mm_add_epi64(sum, _mm_add_epi64(_mm_unpacklo_epi32(sum32, zero), _mm_unpackhi_epi32(sum32, zero)));
+		alignas(16) Uint16 sameLanes[8];
+		_mm_store_si128(reinterpret_cast<__m128i*>(sameLanes), same16);
+
+		for (const auto lane : sameLanes)
+		{
+			same += lane;
+		}
+	}
+
+	alignas(16) Uint16 maximumLanes[8];
+	alignas(16) Uint64 lanes[2];
+	_mm_store_si128(reinterpret_cast<__m128i*>(maximumLanes), maximum);
+
+	for (const auto lane : maximumLanes)
+	{
+		stats.maxError = std::max<Uint32>(stats.maxError, lane);
+	}
+
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), sum);
+	stats.sum += lanes[0] + lanes[1];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), squares);
+	stats.sumSquares += lanes[0] + lanes[1];
+	stats.differing += i - same;
+	stats.count += i;
+#endif
+
+	if (bias)
+	{
+		diffScalar(reinterpret_cast<const Sint16*>(first + i), reinterpret_cast<const Sint16*>(second + i), count - i, stats);
+	}
+
+	else
+	{
+		diffScalar(first + i, second + i, count - i, stats);
+	}
+}
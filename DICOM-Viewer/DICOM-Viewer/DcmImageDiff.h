@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QImage>
+#include <QString>
+#include <memory>
+#include <vector>
+#include "dcmtk/dcmdata/dcfilefo.h"
+
+class DicomImage;
+
+class DcmImageDiff
+{
+	public:
+		struct Stats
+		{
+			Uint32 maxError = 0;
+			Uint64 sum = 0;
+			Uint64 sumSquares = 0;
+			Uint64 differing = 0;
+			Uint64 count = 0;
+
+			void merge(const Stats& other);
+			double meanError() const;
+			double psnr(double peak) const;
+		};
+
+		DcmImageDiff();
+		~DcmImageDiff();
+
+		bool open(DcmFileFormat* first, DcmFileFormat* second, QString& error);
+		unsigned long getFrameCount() const;
+		unsigned long getWidth() const;
+		unsigned long getHeight() const;
+		double getPeak() const;
+		bool compareFrame(unsigned long frame, Stats& stats);
+		bool heatMap(unsigned long frame, QImage& image);
+
+		static void diffUint8(const Uint8* first, const Uint8* second, size_t count, Uint8 bias, Stats& stats);
+		static void diffUint16(const Uint16* first, const Uint16* second, size_t count, Uint16 bias, Stats& stats);
+
+	private:
+		std::unique_ptr<DicomImage> first;
+		std::unique_ptr<DicomImage> second;
+		unsigned long frames = 0;
+		unsigned long width = 0;
+		unsigned long height = 0;
+		double peak = 0;
+		bool color = false;
+
+		bool framePointers(unsigned long frame, const void*& firstData, const void*& secondData, int& representation, size_t& count);
+		static void registerCodecs();
+};
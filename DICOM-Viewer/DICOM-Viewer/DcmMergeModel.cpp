@@ -0,0 +1,155 @@
+#include "DcmMergeModel.h"
+#include <QtWidgets/qcombobox.h>
+
+DcmMergeModel::DcmMergeModel(DcmThreeWayMerge* engine, QObject* parent) : QAbstractTableModel(parent), engine(engine)
+{
+}
+
+//========================================================================================================================
+void DcmMergeModel::refresh(const bool available)
+{
+	// the engine is only read while no merge runs, the dialog empties the model before starting one
+	this->beginResetModel();
+	this->rows = available ? static_cast<int>(this->engine->getConflicts().size()) : 0;
+	this->endResetModel();
+}
+
+//========================================================================================================================
+const QStringList& DcmMergeModel::resolutions()
+{
+	static const QStringList names = { "Ours", "Theirs", "Base" };
+	return names;
+}
+
+//========================================================================================================================
+int DcmMergeModel::rowCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : this->rows;
+}
+
+//========================================================================================================================
+int DcmMergeModel::columnCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : 5;
+}
+
+//========================================================================================================================
+QVariant DcmMergeModel::data(const QModelIndex& index, const int role) const
+{
+	if (!index.isValid() || index.row() >= this->rows || (role != Qt::DisplayRole && role != Qt::EditRole))
+	{
+		return QVariant();
+	}
+
+	// values are described on demand, only the visible rows pay for it
+	const DcmThreeWayMerge::Conflict& conflict = this->engine->getConflicts()[index.row()];
+
+	switch (index.column())
+	{
+		case PathColumn:
+			return conflict.path;
+		case BaseColumn:
+			return DcmThreeWayMerge::describe(conflict.base);
+		case OursColumn:
+			return DcmThreeWayMerge::describe(conflict.ours);
+		case TheirsColumn:
+			return DcmThreeWayMerge::describe(conflict.theirs);
+		case UseColumn:
+			return role == Qt::EditRole ? QVariant(static_cast<int>(conflict.resolution)) : QVariant(resolutions()[static_cast<int>(conflict.resolution)]);
+		default:
+			return QVariant();
+	}
+}
+
+//========================================================================================================================
+bool DcmMergeModel::setData(const QModelIndex& index, const QVariant& value, const int role)
+{
+	if (!index.isValid() || index.column() != UseColumn || role != Qt::EditRole || index.row() >= this->rows)
+	{
+		return false;
+	}
+
+	const int choice = value.toInt();
+
+	if (choice < 0 || choice >= resolutions().size())
+	{
+		return false;
+	}
+
+	this->engine->resolve(index.row(), static_cast<DcmThreeWayMerge::Resolution>(choice));
+	emit dataChanged(index, index, { Qt::DisplayRole, Qt::EditRole });
+	return true;
+}
+
+//========================================================================================================================
+Qt::ItemFlags DcmMergeModel::flags(const QModelIndex& index) const
+{
+	const Qt::ItemFlags flags = QAbstractTableModel::flags(index);
+	return index.column() == UseColumn ? flags | Qt::ItemIsEditable : flags;
+}
+
+//========================================================================================================================
+QVariant DcmMergeModel::headerData(const int section, const Qt::Orientation orientation, const int role) const
+{
+	static const char* headers[] = { "Path", "Base", "Ours", "Theirs", "Use" };
+
+	if (role != Qt::DisplayRole || orientation != Qt::Horizontal || section < 0 || section >= 5)
+	{
+		return QAbstractTableModel::headerData(section, orientation, role);
+	}
+
+	return QString(headers[section]);
+}
+
+//========================================================================================================================
+DcmMergeDelegate::DcmMergeDelegate(QObject* parent) : QStyledItemDelegate(parent)
+{
+}
+
+//========================================================================================================================
+QWidget* DcmMergeDelegate::createEditor(QWidget* parent, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+	if (index.column() != DcmMergeModel::UseColumn)
+	{
+		return QStyledItemDelegate::createEditor(parent, option, index);
+	}
+
+	// a single editor exists at a time instead of a combo box per conflict
+	auto* choice = new QComboBox(parent);
+	choice->addItems(DcmMergeModel::resolutions());
+
+	connect(choice, QOverload<int>::of(&QComboBox::activated), this, [this, choice]()
+	{
+		emit const_cast<DcmMergeDelegate*>(this)->commitData(choice);
+	});
+
+	return choice;
+}
+
+//========================================================================================================================
+void DcmMergeDelegate::setEditorData(QWidget* editor, const QModelIndex& index) const
+{
+	auto* choice = qobject_cast<QComboBox*>(editor);
+
+	if (!choice)
+	{
+		QStyledItemDelegate::setEditorData(editor, index);
+		return;
+	}
+
+	choice->setCurrentIndex(index.data(Qt::EditRole).toInt());
+}
+
+//========================================================================================================================
+void DcmMergeDelegate::setModelData(QWidget* editor, QAbstractItemModel* model, const QModelIndex& index) const
+{
+	auto* choice = qobject_cast<QComboBox*>(editor);
+
+	if (!choice)
+	{
+		QStyledItemDelegate::setModelData(editor, model, index);
+		return;
+	}
+
+	model->setData(index, choice->currentIndex(), Qt::EditRole);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QtWidgets/QStyledItemDelegate>
+#include "DcmThreeWayMerge.h"
+
+class DcmMergeModel final : public QAbstractTableModel
+{
+	Q_OBJECT
+
+	public:
+		enum Column { PathColumn, BaseColumn, OursColumn, TheirsColumn, UseColumn };
+
+		explicit DcmMergeModel(DcmThreeWayMerge* engine, QObject* parent = nullptr);
+		void refresh(bool available);
+		static const QStringList& resolutions();
+		int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+		int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+		QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+		bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+		Qt::ItemFlags flags(const QModelIndex& index) const override;
+		QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+	private:
+		DcmThreeWayMerge* engine;
+		int rows = 0;
+};
+
+class DcmMergeDelegate final : public QStyledItemDelegate
+{
+	Q_OBJECT
+
+	public:
+		explicit DcmMergeDelegate(QObject* parent = nullptr);
+		QWidget* createEditor(QWidget* parent, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+		void setEditorData(QWidget* editor, const QModelIndex& index) const override;
+		void setModelData(QWidget* editor, QAbstractItemModel* model, const QModelIndex& index) const override;
+};
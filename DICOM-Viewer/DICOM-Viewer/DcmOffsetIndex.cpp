@@ -0,0 +1,120 @@
+#include "DcmOffsetIndex.h"
+
+bool DcmOffsetIndex::build(const std::string& fileName)
+{
+	DcmStreamParser parser;
+	parser.setPreviewLength(0);
+	this->clear();
+
+	if (!parser.parseFile(fileName, *this))
+	{
+		this->clear();
+		this->bytesRead = parser.getBytesRead();
+		return false;
+	}
+
+	this->datasetOffset = parser.getDatasetOffset();
+	this->bytesRead = parser.getBytesRead();
+	return true;
+}
+
+//========================================================================================================================
+void DcmOffsetIndex::clear()
+{
+	this->entries.clear();
+	this->occurrences.clear();
+	this->open.clear();
+	this->datasetOffset = 0;
+	this->bytesRead = 0;
+}
+
+//========================================================================================================================
+offile_off_t DcmOffsetIndex::getBytesRead() const
+{
+	return this->bytesRead;
+}
+
+//========================================================================================================================
+bool DcmOffsetIndex::empty() const
+{
+	return this->entries.empty();
+}
+
+//========================================================================================================================
+const DcmOffsetIndex::Entry* DcmOffsetIndex::find(const DcmTagKey& tag, const unsigned long occurrence) const
+{
+	const auto found = this->occurrences.find(key(tag));
+
+	if (found == this->occurrences.end() || occurrence >= found->second.size())
+	{
+		return nullptr;
+	}
+
+	return &this->entries[found->second[occurrence]];
+}
+
+//========================================================================================================================
+offile_off_t DcmOffsetIndex::getDatasetOffset() const
+{
+	return this->datasetOffset;
+}
+
+//========================================================================================================================
+void DcmOffsetIndex::getTopLevelRanges(std::map<DcmTagKey, DcmFastSave::Range>& ranges) const
+{
+	ranges.clear();
+
+	for (const auto& entry : this->entries)
+	{
+		if (entry.depth == 0 && entry.tag.getGroup() != 0x0002)
+		{
+			DcmFastSave::Range& range = ranges[entry.tag];
+			range.offset = entry.offset;
+			range.length = entry.headerLength + entry.valueLength;
+		}
+	}
+}
+
+//========================================================================================================================
+bool DcmOffsetIndex::onEvent(const DcmStreamEvent& event)
+{
+	if (event.kind == DcmStreamEvent::Kind::SequenceEnd || event.kind == DcmStreamEvent::Kind::ItemEnd)
+	{
+		if (!this->open.empty())
+		{
+			Entry& entry = this->entries[this->open.back()];
+			entry.valueLength = event.offset - entry.offset - entry.headerLength;
+			this->open.pop_back();
+		}
+
+		return true;
+	}
+
+	if (event.kind == DcmStreamEvent::Kind::Error)
+	{
+		return true;
+	}
+
+	Entry entry;
+	entry.tag = event.tag;
+	entry.depth = event.depth;
+	entry.offset = event.offset;
+	entry.headerLength = event.headerLength;
+	entry.valueLength = event.valueLength;
+
+	this->occurrences[key(event.tag)].push_back(this->entries.size());
+
+	if (event.kind != DcmStreamEvent::Kind::Element)
+	{
+		this->open.push_back(this->entries.size());
+	}
+
+	this->entries.push_back(entry);
+	return true;
+}
+
+//========================================================================================================================
+Uint32 DcmOffsetIndex::key(const DcmTagKey& tag)
+{
+	return (OFstatic_cast(Uint32, tag.getGroup()) << 16) | tag.getElement();
+}
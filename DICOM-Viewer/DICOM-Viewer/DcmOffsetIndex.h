@@ -0,0 +1,42 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "DcmFastSave.h"
+#include "DcmStreamParser.h"
+
+class DcmOffsetIndex final : public DcmStreamHandler
+{
+	public:
+		struct Entry
+		{
+			DcmTagKey tag;
+			int depth = 0;
+			offile_off_t offset = 0;
+			Uint32 headerLength = 0;
+			offile_off_t valueLength = 0;
+		};
+
+		DcmOffsetIndex() = default;
+		~DcmOffsetIndex() = default;
+
+		bool build(const std::string& fileName);
+		void clear();
+		bool empty() const;
+		const Entry* find(const DcmTagKey& tag, unsigned long occurrence) const;
+		offile_off_t getDatasetOffset() const;
+		offile_off_t getBytesRead() const;
+		void getTopLevelRanges(std::map<DcmTagKey, DcmFastSave::Range>& ranges) const;
+		bool onEvent(const DcmStreamEvent& event) override;
+
+	private:
+		std::vector<Entry> entries;
+		std::unordered_map<Uint32, std::vector<size_t>> occurrences;
+		std::vector<size_t> open;
+		offile_off_t datasetOffset = 0;
+		offile_off_t bytesRead = 0;
+
+		static Uint32 key(const DcmTagKey& tag);
+};
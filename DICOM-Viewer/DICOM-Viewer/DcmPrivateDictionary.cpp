@@ -0,0 +1,167 @@
+#include "DcmPrivateDictionary.h"
+#include <QFile>
+#include <QRegularExpression>
+#include <QTextStream>
+#include "DcmStringPool.h"
+#include "dcmtk/dcmdata/dcitem.h"
+
+std::mutex DcmPrivateDictionary::mutex;
+std::unordered_map<QString, Uint32, DcmPrivateDictionary::Hash> DcmPrivateDictionary::creators;
+std::unordered_map<Uint64, DcmPrivateDictionary::Entry> DcmPrivateDictionary::entries;
+
+bool DcmPrivateDictionary::load(const QString& fileName, int& loaded, QString& error)
+{
+	QFile file(fileName);
+	loaded = 0;
+
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		error = "Cannot open " + fileName;
+		return false;
+	}
+
+	// DCMTK dictionary lines, e.g. (0019,"SIEMENS MR HEADER",08)	CS	ImagingMode	1	PrivateTag
+	const QRegularExpression line("^\\(([0-9A-Fa-f]{4}),\"([^\"]*)\",(?:[0-9A-Fa-fx]{2})?([0-9A-Fa-f]{2})\\)\\s+(\\S+)\\s+(\\S+)");
+	QTextStream in(&file);
+
+	while (!in.atEnd())
+	{
+		const QString text = in.readLine().trimmed();
+
+		if (text.isEmpty() || text.startsWith('#'))
+		{
+			continue;
+		}
+
+		const QRegularExpressionMatch match = line.match(text);
+
+		if (!match.hasMatch())
+		{
+			continue;
+		}
+
+		add(match.captured(2), OFstatic_cast(Uint16, match.captured(1).toUInt(nullptr, 16)), OFstatic_cast(Uint8, match.captured(3).toUInt(nullptr, 16)),
+			match.captured(4), match.captured(5));
+		loaded++;
+	}
+
+	if (loaded == 0)
+	{
+		error = fileName + " has no private tag entries";
+		return false;
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+void DcmPrivateDictionary::add(const QString& creator, const Uint16 group, const Uint8 element, const QString& vr, const QString& name)
+{
+	addBuiltIn();
+	std::lock_guard<std::mutex> lock(mutex);
+	insert(creator, group, element, vr, name);
+}
+
+//========================================================================================================================
+void DcmPrivateDictionary::insert(const QString& creator, const Uint16 group, const Uint8 element, const QString& vr, const QString& name)
+{
+	const QString trimmed = creator.trimmed();
+	auto found = creators.find(trimmed);
+
+	if (found == creators.end())
+	{
+		found = creators.emplace(trimmed, OFstatic_cast(Uint32, creators.size())).first;
+	}
+
+	entries[key(found->second, group, element)] = Entry{ DcmStringPool::intern(vr.toUpper()), DcmStringPool::intern(name) };
+}
+
+//========================================================================================================================
+void DcmPrivateDictionary::addBuiltIn()
+{
+	static std::once_flag once;
+
+	std::call_once(once, []()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		const char* csa = "SIEMENS CSA HEADER";
+		insert(csa, 0x0029, 0x08, "CS", "CSAImageHeaderType");
+		insert(csa, 0x0029, 0x09, "LO", "CSAImageHeaderVersion");
+		insert(csa, 0x0029, 0x10, "OB", "CSAImageHeaderInfo");
+		insert(csa, 0x0029, 0x18, "CS", "CSASeriesHeaderType");
+		insert(csa, 0x0029, 0x19, "LO", "CSASeriesHeaderVersion");
+		insert(csa, 0x0029, 0x20, "OB", "CSASeriesHeaderInfo");
+		const char* nonImage = "SIEMENS CSA NON-IMAGE";
+		insert(nonImage, 0x0029, 0x08, "CS", "CSADataType");
+		insert(nonImage, 0x0029, 0x09, "LO", "CSADataVersion");
+		insert(nonImage, 0x0029, 0x10, "OB", "CSADataInfo");
+	});
+}
+
+//========================================================================================================================
+Uint64 DcmPrivateDictionary::key(const Uint32 creator, const Uint16 group, const Uint8 element)
+{
+	return OFstatic_cast(Uint64, creator) << 24 | OFstatic_cast(Uint64, group) << 8 | element;
+}
+
+//========================================================================================================================
+bool DcmPrivateDictionary::find(const QString& creator, const DcmTagKey& tag, Entry& entry)
+{
+	addBuiltIn();
+	std::lock_guard<std::mutex> lock(mutex);
+	const auto found = creators.find(creator.trimmed());
+
+	if (found == creators.end())
+	{
+		return false;
+	}
+
+	// copied under the lock, loading a dictionary may redefine the entry while workers read it
+	const auto defined = entries.find(key(found->second, tag.getGroup(), OFstatic_cast(Uint8, tag.getElement() & 0xFF)));
+
+	if (defined == entries.end())
+	{
+		return false;
+	}
+
+	entry = defined->second;
+	return true;
+}
+
+//========================================================================================================================
+bool DcmPrivateDictionary::find(DcmElement* element, Entry& entry)
+{
+	const DcmTagKey tag = element->getTag().getBaseTag();
+
+	if (!(tag.getGroup() & 1) || tag.getGroup() <= 0x0007 || tag.getGroup() == 0xFFFF || tag.getElement() <= 0x00FF)
+	{
+		return false;
+	}
+
+	const QString creator = creatorOf(element);
+	return !creator.isEmpty() && find(creator, tag, entry);
+}
+
+//========================================================================================================================
+QString DcmPrivateDictionary::creatorOf(DcmElement* element)
+{
+	// (gggg,xxee) is reserved by the creator string in (gggg,00xx) of the same item
+	DcmItem* parent = element->getParentItem();
+	const DcmTagKey tag = element->getTag().getBaseTag();
+	OFString creator;
+
+	if (!parent || parent->findAndGetOFString(DcmTagKey(tag.getGroup(), tag.getElement() >> 8), creator).bad())
+	{
+		return QString();
+	}
+
+	return QString::fromLatin1(creator.c_str()).trimmed();
+}
+
+//========================================================================================================================
+size_t DcmPrivateDictionary::size()
+{
+	addBuiltIn();
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries.size();
+}
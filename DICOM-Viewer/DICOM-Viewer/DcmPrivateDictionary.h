@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QString>
+#include <mutex>
+#include <unordered_map>
+#include "dcmtk/dcmdata/dcelem.h"
+#include "dcmtk/dcmdata/dctagkey.h"
+
+class DcmPrivateDictionary
+{
+	public:
+		struct Entry
+		{
+			QString vr;
+			QString name;
+		};
+
+		static bool load(const QString& fileName, int& loaded, QString& error);
+		static void add(const QString& creator, Uint16 group, Uint8 element, const QString& vr, const QString& name);
+		static bool find(const QString& creator, const DcmTagKey& tag, Entry& entry);
+		static bool find(DcmElement* element, Entry& entry);
+		static QString creatorOf(DcmElement* element);
+		static size_t size();
+
+	private:
+		struct Hash
+		{
+			size_t operator()(const QString& value) const { return qHash(value); }
+		};
+
+		static std::mutex mutex;
+		static std::unordered_map<QString, Uint32, Hash> creators;
+		static std::unordered_map<Uint64, Entry> entries;
+		static void addBuiltIn();
+		static void insert(const QString& creator, Uint16 group, Uint8 element, const QString& vr, const QString& name);
+		static Uint64 key(Uint32 creator, Uint16 group, Uint8 element);
+};
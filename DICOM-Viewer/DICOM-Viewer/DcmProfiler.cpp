@@ -0,0 +1,157 @@
+#include "DcmProfiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+DcmProfiler::Scope::Scope(const char* name) : name(name), start(DcmProfiler::now())
+{
+}
+
+//========================================================================================================================
+DcmProfiler::Scope::~Scope()
+{
+	DcmProfiler::instance().addSpan(this->name, this->start, DcmProfiler::now() - this->start);
+}
+
+//========================================================================================================================
+DcmProfiler::Timer::Timer(long long& total) : total(total), start(DcmProfiler::now())
+{
+}
+
+//========================================================================================================================
+DcmProfiler::Timer::~Timer()
+{
+	// only adds to the caller's total, the profiler is not touched so hot paths stay lock free
+	this->total += DcmProfiler::now() - this->start;
+}
+
+//========================================================================================================================
+DcmProfiler& DcmProfiler::instance()
+{
+	static DcmProfiler profiler;
+	return profiler;
+}
+
+//========================================================================================================================
+long long DcmProfiler::now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//========================================================================================================================
+void DcmProfiler::setEnabled(const bool enabled)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->enabled = enabled;
+}
+
+//========================================================================================================================
+bool DcmProfiler::isEnabled() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->enabled;
+}
+
+//========================================================================================================================
+void DcmProfiler::addSpan(const char* name, const long long start, const long long duration)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	if (!this->enabled)
+	{
+		return;
+	}
+
+	Summary& entry = this->summary[name];
+	entry.calls++;
+	entry.total += duration;
+	entry.max = std::max(entry.max, duration);
+
+	// the summary keeps counting once the trace buffer is full
+	if (this->spans.size() < maxSpans)
+	{
+		Span span;
+		span.name = name;
+		span.start = start;
+		span.duration = duration;
+		span.thread = static_cast<unsigned long>(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xFFFFFF);
+		this->spans.push_back(span);
+	}
+}
+
+//========================================================================================================================
+void DcmProfiler::count(const std::string& name, const long long value)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	if (this->enabled)
+	{
+		this->counters[name] += value;
+	}
+}
+
+//========================================================================================================================
+void DcmProfiler::clear()
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->spans.clear();
+	this->summary.clear();
+	this->counters.clear();
+}
+
+//========================================================================================================================
+std::map<std::string, DcmProfiler::Summary> DcmProfiler::getSummary() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->summary;
+}
+
+//========================================================================================================================
+std::map<std::string, long long> DcmProfiler::getCounters() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->counters;
+}
+
+//========================================================================================================================
+bool DcmProfiler::exportChromeTrace(const std::string& fileName) const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::ofstream out(fileName, std::ios::out | std::ios::trunc);
+
+	if (!out)
+	{
+		return false;
+	}
+
+	long long origin = this->spans.empty() ? 0 : this->spans.front().start;
+	long long last = 0;
+
+	for (const auto& span : this->spans)
+	{
+		origin = std::min(origin, span.start);
+	}
+
+	out << "{\"traceEvents\":[";
+	bool first = true;
+
+	for (const auto& span : this->spans)
+	{
+		out << (first ? "\n" : ",\n") << "{\"name\":\"" << span.name << "\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":" << span.thread
+			<< ",\"ts\":" << span.start - origin << ",\"dur\":" << span.duration << "}";
+		last = std::max(last, span.start - origin + span.duration);
+		first = false;
+	}
+
+	for (const auto& counter : this->counters)
+	{
+		out << (first ? "\n" : ",\n") << "{\"name\":\"" << counter.first << "\",\"ph\":\"C\",\"pid\":1,\"ts\":" << last
+			<< ",\"args\":{\"value\":" << counter.second << "}}";
+		first = false;
+	}
+
+	out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return out.good();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class DcmProfiler
+{
+	public:
+		struct Span
+		{
+			const char* name = nullptr;
+			long long start = 0;
+			long long duration = 0;
+			unsigned long thread = 0;
+		};
+
+		struct Summary
+		{
+			long long calls = 0;
+			long long total = 0;
+			long long max = 0;
+		};
+
+		class Scope
+		{
+			public:
+				explicit Scope(const char* name);
+				~Scope();
+				Scope(const Scope&) = delete;
+				Scope& operator=(const Scope&) = delete;
+
+			private:
+				const char* name;
+				long long start;
+		};
+
+		class Timer
+		{
+			public:
+				explicit Timer(long long& total);
+				~Timer();
+				Timer(const Timer&) = delete;
+				Timer& operator=(const Timer&) = delete;
+
+			private:
+				long long& total;
+				long long start;
+		};
+
+		static DcmProfiler& instance();
+		static long long now();
+		void setEnabled(bool enabled);
+		bool isEnabled() const;
+		void addSpan(const char* name, long long start, long long duration);
+		void count(const std::string& name, long long value = 1);
+		void clear();
+		std::map<std::string, Summary> getSummary() const;
+		std::map<std::string, long long> getCounters() const;
+		bool exportChromeTrace(const std::string& fileName) const;
+
+	private:
+		DcmProfiler() = default;
+		~DcmProfiler() = default;
+
+		mutable std::mutex mutex;
+		std::vector<Span> spans;
+		std::map<std::string, Summary> summary;
+		std::map<std::string, long long> counters;
+		bool enabled = true;
+		static const size_t maxSpans = 1000000;
+};
@@ -0,0 +1,574 @@
+#include "DcmStreamParser.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dctag.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+// how far past a damaged element the parser looks for the next plausible header before giving up on the rest of the file
+#define RESYNC_WINDOW 1048576
+
+void DcmStreamParser::setPreviewLength(const Uint32 length)
+{
+	this->previewLength = length;
+}
+
+//========================================================================================================================
+void DcmStreamParser::setTolerant(const bool tolerant)
+{
+	this->tolerant = tolerant;
+}
+
+//========================================================================================================================
+offile_off_t DcmStreamParser::getDatasetOffset() const
+{
+	return this->datasetOffset;
+}
+
+//========================================================================================================================
+offile_off_t DcmStreamParser::getFileSize() const
+{
+	return this->fileSize;
+}
+
+//========================================================================================================================
+offile_off_t DcmStreamParser::getBytesRead() const
+{
+	return this->bytesRead;
+}
+
+//========================================================================================================================
+size_t DcmStreamParser::read(void* data, const size_t length)
+{
+	// counts what actually came from the file, skipped values and pixel data are not part of it
+	const size_t count = this->in.fread(data, 1, length);
+	this->bytesRead += count;
+	return count;
+}
+
+//========================================================================================================================
+E_TransferSyntax DcmStreamParser::getTransferSyntax() const
+{
+	return this->xfer;
+}
+
+//========================================================================================================================
+const std::string& DcmStreamParser::getError() const
+{
+	return this->error;
+}
+
+//========================================================================================================================
+offile_off_t DcmStreamParser::getErrorOffset() const
+{
+	return this->errorOffset;
+}
+
+//========================================================================================================================
+const std::vector<DcmStreamError>& DcmStreamParser::getErrors() const
+{
+	return this->errors;
+}
+
+//========================================================================================================================
+Uint16 DcmStreamParser::readUint16(const unsigned char* data, const bool bigEndian)
+{
+	return bigEndian ? OFstatic_cast(Uint16, (data[0] << 8) | data[1]) : OFstatic_cast(Uint16, data[0] | (data[1] << 8));
+}
+
+//========================================================================================================================
+Uint32 DcmStreamParser::readUint32(const unsigned char* data, const bool bigEndian)
+{
+	return bigEndian
+		? (OFstatic_cast(Uint32, data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3]
+		: data[0] | (data[1] << 8) | (data[2] << 16) | (OFstatic_cast(Uint32, data[3]) << 24);
+}
+
+//========================================================================================================================
+bool DcmStreamParser::parseFile(const std::string& fileName, DcmStreamHandler& handler)
+{
+	this->handler = &handler;
+	this->stopped = false;
+	this->error.clear();
+	this->errorOffset = 0;
+	this->errors.clear();
+	this->open.clear();
+	this->lastTag = DcmTagKey(0, 0);
+	this->bytesRead = 0;
+
+	if (!this->in.fopen(fileName.c_str(), "rb"))
+	{
+		return this->fail("Cannot open file", 0);
+	}
+
+	this->in.fseek(0, SEEK_END);
+	this->fileSize = this->in.ftell();
+	offile_off_t offset = 0;
+	bool ok = this->readMeta(offset);
+
+	if (ok)
+	{
+		this->datasetOffset = offset;
+		ok = this->parseDataset(offset, this->fileSize, 0, this->explicitVR, this->bigEndian);
+
+		// every recovery resumes strictly after the damage, so the file is still read front to back only once
+		while (!ok && this->tolerant && !this->stopped && this->recover(offset))
+		{
+			ok = this->parseDataset(offset, this->fileSize, 0, this->explicitVR, this->bigEndian);
+		}
+	}
+
+	this->in.fclose();
+	return ok || this->stopped || (this->tolerant && !this->errors.empty());
+}
+
+//========================================================================================================================
+bool DcmStreamParser::readMeta(offile_off_t& offset)
+{
+	char magic[4];
+	this->xfer = EXS_LittleEndianImplicit;
+
+	if (this->fileSize < 132 || this->in.fseek(128, SEEK_SET) != 0 || this->read(magic, 4) != 4 || memcmp(magic, "DICM", 4) != 0)
+	{
+		// no preamble, guess the encoding from the first element header
+		unsigned char header[6];
+		offset = 0;
+
+		if (this->in.fseek(0, SEEK_SET) != 0 || this->read(header, 6) != 6)
+		{
+			return this->fail("File too short", 0);
+		}
+
+		this->explicitVR = isupper(header[4]) && isupper(header[5]);
+		this->bigEndian = false;
+		this->xfer = this->explicitVR ? EXS_LittleEndianExplicit : EXS_LittleEndianImplicit;
+		return true;
+	}
+
+	offset = 132;
+	DcmStreamEvent event;
+
+	while (offset < this->fileSize && this->readHeader(offset, true, false, event) && event.tag.getGroup() == 0x0002)
+	{
+		if (!this->emit(event))
+		{
+			return false;
+		}
+
+		if (event.tag == DCM_TransferSyntaxUID && event.value)
+		{
+			this->xfer = DcmXfer(event.value->c_str()).getXfer();
+		}
+
+		offset += event.headerLength + event.valueLength;
+	}
+
+	const DcmXfer transferSyntax(this->xfer);
+
+	if (transferSyntax.getStreamCompression() != ESC_none)
+	{
+		return this->fail("Deflated transfer syntax is not supported in streaming mode", offset);
+	}
+
+	this->explicitVR = transferSyntax.isExplicitVR() != OFFalse;
+	this->bigEndian = transferSyntax.getByteOrder() == EBO_BigEndian;
+	return true;
+}
+
+//========================================================================================================================
+bool DcmStreamParser::readHeader(const offile_off_t offset, const bool explicitVR, const bool bigEndian, DcmStreamEvent& event)
+{
+	unsigned char header[12];
+
+	if (this->in.fseek(offset, SEEK_SET) != 0 || this->read(header, 8) != 8)
+	{
+		return this->fail("Unexpected end of file", offset);
+	}
+
+	event.kind = DcmStreamEvent::Kind::Element;
+	event.offset = offset;
+	event.value = nullptr;
+	event.tag.set(readUint16(header, bigEndian), readUint16(header + 2, bigEndian));
+
+	if (event.tag.getGroup() == 0xFFFE)
+	{
+		event.vr = EVR_na;
+		event.valueLength = readUint32(header + 4, bigEndian);
+		event.headerLength = 8;
+		return true;
+	}
+
+	if (!explicitVR)
+	{
+		event.vr = DcmTag(event.tag).getEVR();
+		event.valueLength = readUint32(header + 4, bigEndian);
+		event.headerLength = 8;
+	}
+
+	else
+	{
+		const char vrName[3] = { OFstatic_cast(char, header[4]), OFstatic_cast(char, header[5]), 0 };
+		const DcmVR vr(vrName);
+		event.vr = vr.getEVR();
+
+		if (vr.usesExtendedLengthEncoding())
+		{
+			if (this->read(header + 8, 4) != 4)
+			{
+				return this->fail("Unexpected end of file", offset);
+			}
+
+			event.valueLength = readUint32(header + 8, bigEndian);
+			event.headerLength = 12;
+		}
+
+		else
+		{
+			event.valueLength = readUint16(header + 6, bigEndian);
+			event.headerLength = 8;
+		}
+	}
+
+	const bool preview = event.valueLength <= this->previewLength || event.tag == DCM_TransferSyntaxUID;
+
+	if (event.valueLength != DCM_UndefinedLength && preview && event.vr != EVR_SQ)
+	{
+		this->value.resize(event.valueLength);
+
+		if (event.valueLength && this->read(&this->value[0], event.valueLength) != event.valueLength)
+		{
+			return this->fail("Unexpected end of file", offset);
+		}
+
+		event.value = &this->value;
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+bool DcmStreamParser::parseDataset(offile_off_t& offset, const offile_off_t end, const int depth, const bool explicitVR, const bool bigEndian)
+{
+	DcmStreamEvent event;
+
+	while (offset < end)
+	{
+		if (!this->readHeader(offset, explicitVR, bigEndian, event))
+		{
+			return false;
+		}
+
+		event.depth = depth;
+
+		if (event.tag == DCM_ItemDelimitationItem)
+		{
+			offset += event.headerLength;
+			return true;
+		}
+
+		const offile_off_t valueOffset = offset + event.headerLength;
+		const bool undefined = event.valueLength == DCM_UndefinedLength;
+
+		if (!undefined && valueOffset + event.valueLength > this->fileSize)
+		{
+			return this->fail("Value length exceeds file size", offset);
+		}
+
+		if (event.vr == EVR_SQ || undefined)
+		{
+			event.kind = DcmStreamEvent::Kind::SequenceStart;
+
+			if (!this->emit(event))
+			{
+				return false;
+			}
+
+			// undefined length UN is always implicit little endian, undefined length pixel data holds fragments
+			const bool nestedExplicitVR = event.vr == EVR_UN ? false : explicitVR;
+			const bool encapsulated = event.tag == DCM_PixelData;
+			offset = valueOffset;
+
+			if (!this->parseSequence(offset, undefined ? this->fileSize : valueOffset + event.valueLength, depth + 1, nestedExplicitVR, bigEndian, encapsulated))
+			{
+				return false;
+			}
+
+			event.kind = DcmStreamEvent::Kind::SequenceEnd;
+			event.offset = offset;
+			event.value = nullptr;
+		}
+
+		else
+		{
+			offset = valueOffset + event.valueLength;
+		}
+
+		if (!this->emit(event))
+		{
+			return false;
+		}
+
+		if (depth == 0)
+		{
+			this->lastTag = event.tag;
+		}
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+bool DcmStreamParser::parseSequence(offile_off_t& offset, const offile_off_t end, const int depth, const bool explicitVR, const bool bigEndian, const bool encapsulated)
+{
+	DcmStreamEvent event;
+
+	while (offset < end)
+	{
+		if (!this->readHeader(offset, explicitVR, bigEndian, event))
+		{
+			return false;
+		}
+
+		event.depth = depth;
+
+		if (event.tag == DCM_SequenceDelimitationItem)
+		{
+			offset += event.headerLength;
+			return true;
+		}
+
+		if (event.tag != DCM_Item)
+		{
+			return this->fail("Expected item tag inside sequence", offset);
+		}
+
+		event.kind = DcmStreamEvent::Kind::ItemStart;
+
+		if (!this->emit(event))
+		{
+			return false;
+		}
+
+		offset += event.headerLength;
+
+		if (encapsulated)
+		{
+			offset += event.valueLength;
+		}
+
+		else if (!this->parseDataset(offset, event.valueLength == DCM_UndefinedLength ? this->fileSize : offset + event.valueLength, depth + 1, explicitVR, bigEndian))
+		{
+			return false;
+		}
+
+		event.kind = DcmStreamEvent::Kind::ItemEnd;
+		event.offset = offset;
+		event.value = nullptr;
+
+		if (!this->emit(event))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+bool DcmStreamParser::emit(const DcmStreamEvent& event)
+{
+	if (!this->handler->onEvent(event))
+	{
+		this->stopped = true;
+		return false;
+	}
+
+	if (event.kind == DcmStreamEvent::Kind::SequenceStart || event.kind == DcmStreamEvent::Kind::ItemStart)
+	{
+		this->open.push_back(event);
+	}
+
+	else if ((event.kind == DcmStreamEvent::Kind::SequenceEnd || event.kind == DcmStreamEvent::Kind::ItemEnd) && !this->open.empty())
+	{
+		this->open.pop_back();
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+bool DcmStreamParser::recover(offile_off_t& offset)
+{
+	const offile_off_t bad = this->errorOffset;
+
+	// close whatever the damage left open so handlers still see balanced events
+	while (!this->open.empty())
+	{
+		DcmStreamEvent event = this->open.back();
+		event.kind = event.kind == DcmStreamEvent::Kind::SequenceStart ? DcmStreamEvent::Kind::SequenceEnd : DcmStreamEvent::Kind::ItemEnd;
+		event.offset = bad;
+		event.value = nullptr;
+
+		if (!this->emit(event))
+		{
+			return false;
+		}
+	}
+
+	const offile_off_t next = this->resync(bad + 1);
+	DcmStreamError region;
+	region.offset = bad;
+	region.length = next - bad;
+	region.message = this->error;
+	this->errors.push_back(region);
+
+	DcmStreamEvent event;
+	event.kind = DcmStreamEvent::Kind::Error;
+	event.tag = DcmTagKey(0xFFFF, 0xFFFF);
+	event.vr = EVR_UNKNOWN;
+	event.offset = bad;
+	event.valueLength = OFstatic_cast(Uint32, std::min<offile_off_t>(region.length, 0xFFFFFFFE));
+	event.value = &this->errors.back().message;
+
+	if (!this->emit(event))
+	{
+		return false;
+	}
+
+	offset = next;
+	return next < this->fileSize;
+}
+
+//========================================================================================================================
+offile_off_t DcmStreamParser::resync(const offile_off_t from)
+{
+	if (from >= this->fileSize)
+	{
+		return this->fileSize;
+	}
+
+	// one read of a bounded window, scanned once; anything beyond it is reported as part of the damaged region
+	const size_t size = OFstatic_cast(size_t, std::min<offile_off_t>(this->fileSize - from, RESYNC_WINDOW + 12));
+	this->window.resize(size);
+
+	if (this->in.fseek(from, SEEK_SET) != 0 || this->read(this->window.data(), size) != size)
+	{
+		return this->fileSize;
+	}
+
+	for (size_t i = 0; i < size && i < RESYNC_WINDOW; i++)
+	{
+		DcmTagKey tag;
+		DcmTagKey following;
+		offile_off_t next = 0;
+		offile_off_t after = 0;
+
+		if (!this->isPlausible(this->window.data() + i, size - i, from + i, tag, next))
+		{
+			continue;
+		}
+
+		// a second header right behind the candidate makes a false match in random bytes very unlikely
+		if (next < 0 || next >= this->fileSize || OFstatic_cast(size_t, next - from) + 8 > size)
+		{
+			return from + i;
+		}
+
+		const size_t relative = OFstatic_cast(size_t, next - from);
+		const DcmTagKey previous = this->lastTag;
+		this->lastTag = tag;
+		const bool chained = this->isPlausible(this->window.data() + relative, size - relative, next, following, after);
+		this->lastTag = previous;
+
+		if (chained)
+		{
+			return from + i;
+		}
+	}
+
+	return this->fileSize;
+}
+
+//========================================================================================================================
+bool DcmStreamParser::isPlausible(const unsigned char* data, const size_t available, const offile_off_t position, DcmTagKey& tag, offile_off_t& next) const
+{
+	if (available < 8)
+	{
+		return false;
+	}
+
+	tag.set(readUint16(data, this->bigEndian), readUint16(data + 2, this->bigEndian));
+
+	if (tag <= this->lastTag || tag.getGroup() < 0x0008 || tag.getGroup() >= 0xFFFE)
+	{
+		return false;
+	}
+
+	Uint32 length = 0;
+	Uint32 headerLength = 8;
+	bool sequence = true;
+
+	if (this->explicitVR)
+	{
+		const char vrName[3] = { OFstatic_cast(char, data[4]), OFstatic_cast(char, data[5]), 0 };
+
+		if (!isupper(data[4]) || !isupper(data[5]))
+		{
+			return false;
+		}
+
+		const DcmVR vr(vrName);
+
+		if (!vr.isStandard() || strcmp(vr.getVRName(), vrName) != 0)
+		{
+			return false;
+		}
+
+		if (vr.usesExtendedLengthEncoding())
+		{
+			if (available < 12 || data[6] || data[7])
+			{
+				return false;
+			}
+
+			length = readUint32(data + 8, this->bigEndian);
+			headerLength = 12;
+		}
+
+		else
+		{
+			length = readUint16(data + 6, this->bigEndian);
+		}
+
+		sequence = vr.getEVR() == EVR_SQ || vr.getEVR() == EVR_UN || vr.getEVR() == EVR_OB || vr.getEVR() == EVR_OW;
+	}
+
+	else
+	{
+		length = readUint32(data + 4, this->bigEndian);
+	}
+
+	if (length == DCM_UndefinedLength)
+	{
+		next = -1;
+		return sequence && (this->explicitVR || DcmTag(tag).getEVR() != EVR_UNKNOWN);
+	}
+
+	next = position + headerLength + length;
+
+	// values are always padded to an even length
+	if ((length & 1) || next > this->fileSize)
+	{
+		return false;
+	}
+
+	return this->explicitVR || DcmTag(tag).getEVR() != EVR_UNKNOWN;
+}
+
+//========================================================================================================================
+bool DcmStreamParser::fail(const std::string& message, const offile_off_t offset)
+{
+	this->error = message;
+	this->errorOffset = offset;
+	return false;
+}
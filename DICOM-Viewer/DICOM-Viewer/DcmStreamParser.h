@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "dcmtk/dcmdata/dctagkey.h"
+#include "dcmtk/dcmdata/dcvr.h"
+#include "dcmtk/dcmdata/dcxfer.h"
+#include "dcmtk/ofstd/offile.h"
+
+struct DcmStreamEvent
+{
+	enum class Kind
+	{
+		Element,
+		SequenceStart,
+		SequenceEnd,
+		ItemStart,
+		ItemEnd,
+		Error
+	};
+
+	Kind kind = Kind::Element;
+	DcmTagKey tag;
+	DcmEVR vr = EVR_UNKNOWN;
+	int depth = 0;
+	offile_off_t offset = 0;
+	Uint32 headerLength = 0;
+	Uint32 valueLength = 0;
+	const std::string* value = nullptr;
+};
+
+struct DcmStreamError
+{
+	offile_off_t offset = 0;
+	offile_off_t length = 0;
+	std::string message;
+};
+
+class DcmStreamHandler
+{
+	public:
+		virtual ~DcmStreamHandler() = default;
+		virtual bool onEvent(const DcmStreamEvent& event) = 0;
+};
+
+class DcmStreamParser
+{
+	public:
+		DcmStreamParser() = default;
+		~DcmStreamParser() = default;
+
+		void setPreviewLength(Uint32 length);
+		void setTolerant(bool tolerant);
+		bool parseFile(const std::string& fileName, DcmStreamHandler& handler);
+		offile_off_t getDatasetOffset() const;
+		offile_off_t getFileSize() const;
+		offile_off_t getBytesRead() const;
+		E_TransferSyntax getTransferSyntax() const;
+		const std::string& getError() const;
+		offile_off_t getErrorOffset() const;
+		const std::vector<DcmStreamError>& getErrors() const;
+
+	private:
+		OFFile in;
+		DcmStreamHandler* handler = nullptr;
+		Uint32 previewLength = 64;
+		offile_off_t fileSize = 0;
+		offile_off_t bytesRead = 0;
+		offile_off_t datasetOffset = 0;
+		E_TransferSyntax xfer = EXS_Unknown;
+		bool explicitVR = true;
+		bool bigEndian = false;
+		bool stopped = false;
+		bool tolerant = false;
+		std::string value;
+		std::string error;
+		offile_off_t errorOffset = 0;
+		std::vector<DcmStreamError> errors;
+		std::vector<DcmStreamEvent> open;
+		std::vector<unsigned char> window;
+		DcmTagKey lastTag;
+
+		size_t read(void* data, size_t length);
+		bool readMeta(offile_off_t& offset);
+		bool readHeader(offile_off_t offset, bool explicitVR, bool bigEndian, DcmStreamEvent& event);
+		bool parseDataset(offile_off_t& offset, offile_off_t end, int depth, bool explicitVR, bool bigEndian);
+		bool parseSequence(offile_off_t& offset, offile_off_t end, int depth, bool explicitVR, bool bigEndian, bool encapsulated);
+		bool emit(const DcmStreamEvent& event);
+		bool recover(offile_off_t& offset);
+		offile_off_t resync(offile_off_t from);
+		bool isPlausible(const unsigned char* data, size_t available, offile_off_t position, DcmTagKey& tag, offile_off_t& next) const;
+		bool fail(const std::string& message, offile_off_t offset);
+		static Uint16 readUint16(const unsigned char* data, bool bigEndian);
+		static Uint32 readUint32(const unsigned char* data, bool bigEndian);
+};
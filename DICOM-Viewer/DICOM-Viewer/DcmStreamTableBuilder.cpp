@@ -0,0 +1,172 @@
+#include "DcmStreamTableBuilder.h"
+#include "DcmStringPool.h"
+#include <cstring>
+#include "dcmtk/dcmdata/dctag.h"
+
+DcmStreamTableBuilder::DcmStreamTableBuilder(DcmElementList& elements) : elements(elements)
+{
+}
+
+//========================================================================================================================
+bool DcmStreamTableBuilder::onEvent(const DcmStreamEvent& event)
+{
+	switch (event.kind)
+	{
+		case DcmStreamEvent::Kind::Element:
+		case DcmStreamEvent::Kind::SequenceStart:
+		{
+			const DcmStringPool::Descriptor& descriptor = DcmStringPool::descriptor(event.tag, event.vr);
+			int vm = 1;
+			const QString value = event.kind == DcmStreamEvent::Kind::Element ? formatValue(event, vm) : QString();
+			DcmWidgetElement element = DcmWidgetElement(
+				descriptor.tag,
+				descriptor.vr,
+				DcmStringPool::number(vm),
+				DcmStringPool::number(event.valueLength),
+				descriptor.description,
+				DcmStringPool::intern(value));
+			element.setDepth(event.depth);
+			element.setLocation(event.offset, event.headerLength, event.valueLength);
+
+			if (event.kind == DcmStreamEvent::Kind::SequenceStart)
+			{
+				this->open.push_back(this->elements.size());
+			}
+
+			this->elements.push_back(std::move(element));
+			break;
+		}
+
+		case DcmStreamEvent::Kind::ItemStart:
+		{
+			DcmWidgetElement element = DcmWidgetElement(DcmStringPool::descriptor(event.tag, EVR_na).tag, QStringLiteral("na"), DcmStringPool::number(1), DcmStringPool::number(event.valueLength), QStringLiteral("Item"), QString());
+			element.setDepth(event.depth);
+			element.setLocation(event.offset, event.headerLength, event.valueLength);
+			this->open.push_back(this->elements.size());
+			this->elements.push_back(std::move(element));
+			break;
+		}
+
+		case DcmStreamEvent::Kind::ItemEnd:
+		{
+			DcmWidgetElement element = DcmWidgetElement(QStringLiteral("(FFFE,E00D)"), QString(), DcmStringPool::number(0), DcmStringPool::number(0), QStringLiteral("ItemDelimitationItem"), QString());
+			element.setDepth(event.depth);
+			this->close(event.offset);
+			this->elements.push_back(element);
+			break;
+		}
+
+		case DcmStreamEvent::Kind::Error:
+		{
+			const QString message = event.value ? QString::fromStdString(*event.value) : QString();
+			DcmWidgetElement element = DcmWidgetElement(QStringLiteral("(FFFF,FFFF)"), QString(), DcmStringPool::number(0), DcmStringPool::number(event.valueLength),
+				QStringLiteral("Damaged region"), message + " at offset " + QString::number(event.offset));
+			element.setDepth(0);
+			element.setLocation(event.offset, 0, event.valueLength);
+			element.setCorrupt(true);
+			this->elements.push_back(std::move(element));
+			break;
+		}
+
+		case DcmStreamEvent::Kind::SequenceEnd:
+		{
+			DcmWidgetElement element = DcmWidgetElement(QStringLiteral("(FFFE,E0DD)"), QString(), DcmStringPool::number(0), DcmStringPool::number(0), QStringLiteral("SequenceDelimitationItem"), QString());
+			element.setDepth(event.depth);
+			this->close(event.offset);
+			this->elements.push_back(element);
+			break;
+		}
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+void DcmStreamTableBuilder::close(const offile_off_t end)
+{
+	if (this->open.empty())
+	{
+		return;
+	}
+
+	DcmWidgetElement& element = this->elements[this->open.back()];
+	element.setLocation(element.getOffset(), element.getHeaderLength(), end - element.getOffset() - element.getHeaderLength());
+	this->open.pop_back();
+}
+
+//========================================================================================================================
+QString DcmStreamTableBuilder::formatValue(const DcmStreamEvent& event, int& vm)
+{
+	if (!event.value)
+	{
+		vm = 0;
+		return QString("Not Loaded");
+	}
+
+	const std::string& bytes = *event.value;
+	const auto* data = reinterpret_cast<const unsigned char*>(bytes.data());
+	QStringList values;
+
+	switch (event.vr)
+	{
+		case EVR_US:
+			for (size_t i = 0; i + 2 <= bytes.size(); i += 2)
+				values.append(QString::number(data[i] | (data[i + 1] << 8)));
+			break;
+
+		case EVR_SS:
+			for (size_t i = 0; i + 2 <= bytes.size(); i += 2)
+				values.append(QString::number(static_cast<Sint16>(data[i] | (data[i + 1] << 8))));
+			break;
+
+		case EVR_UL:
+		case EVR_SL:
+		case EVR_FL:
+		case EVR_AT:
+			for (size_t i = 0; i + 4 <= bytes.size(); i += 4)
+			{
+				Uint32 raw = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16) | (static_cast<Uint32>(data[i + 3]) << 24);
+				Float32 real;
+				memcpy(&real, &raw, sizeof(real));
+
+				if (event.vr == EVR_UL)
+					values.append(QString::number(raw));
+				else if (event.vr == EVR_SL)
+					values.append(QString::number(static_cast<Sint32>(raw)));
+				else if (event.vr == EVR_FL)
+					values.append(QString::number(real));
+				else
+					values.append(QString("(%1,%2)").arg(raw & 0xFFFF, 4, 16, QChar('0')).arg(raw >> 16, 4, 16, QChar('0')).toUpper());
+			}
+			break;
+
+		case EVR_FD:
+			for (size_t i = 0; i + 8 <= bytes.size(); i += 8)
+			{
+				Float64 real;
+				memcpy(&real, data + i, sizeof(real));
+				values.append(QString::number(real));
+			}
+			break;
+
+		case EVR_OB:
+		case EVR_OW:
+		case EVR_OF:
+		case EVR_UN:
+		case EVR_UNKNOWN:
+			for (size_t i = 0; i < bytes.size() && i < 10; i++)
+				values.append(QString("%1").arg(static_cast<uint>(data[i]), 2, 16, QChar('0')));
+			vm = 1;
+			return values.join(" ");
+
+		default:
+		{
+			const QString text = QString::fromLatin1(bytes.c_str()).trimmed();
+			vm = text.isEmpty() ? 0 : text.count('\\') + 1;
+			return text.split('\\').join(" ");
+		}
+	}
+
+	vm = values.size();
+	return values.join(" ");
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+#include "DcmStreamParser.h"
+#include "DcmWidgetElement.h"
+
+class DcmStreamTableBuilder final : public DcmStreamHandler
+{
+	public:
+		explicit DcmStreamTableBuilder(DcmElementList& elements);
+		~DcmStreamTableBuilder() = default;
+
+		bool onEvent(const DcmStreamEvent& event) override;
+		static QString formatValue(const DcmStreamEvent& event, int& vm);
+
+	private:
+		DcmElementList& elements;
+		std::vector<size_t> open;
+
+		void close(offile_off_t end);
+};
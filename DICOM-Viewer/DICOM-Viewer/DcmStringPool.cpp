@@ -0,0 +1,91 @@
+#include "DcmStringPool.h"
+#include <cstring>
+#include "dcmtk/dcmdata/dctag.h"
+
+#define CACHED_NUMBERS 1024
+#define MAX_INTERNED_LENGTH 32
+#define MAX_INTERNED_STRINGS 65536
+
+std::mutex DcmStringPool::mutex;
+std::unordered_map<QString, QString, DcmStringPool::Hash> DcmStringPool::strings;
+std::unordered_map<unsigned long long, DcmStringPool::Descriptor> DcmStringPool::descriptors;
+std::vector<QString> DcmStringPool::numbers;
+
+QString DcmStringPool::intern(const QString& value)
+{
+	// long values are rarely repeated, keep them out of the pool
+	if (value.size() > MAX_INTERNED_LENGTH)
+	{
+		return value;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	const auto found = strings.find(value);
+
+	if (found != strings.end())
+	{
+		return found->second;
+	}
+
+	if (strings.size() >= MAX_INTERNED_STRINGS)
+	{
+		return value;
+	}
+
+	return strings.emplace(value, value).first->second;
+}
+
+//========================================================================================================================
+QString DcmStringPool::number(const unsigned long value)
+{
+	if (value >= CACHED_NUMBERS)
+	{
+		return QString::number(value);
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (numbers.empty())
+	{
+		numbers.reserve(CACHED_NUMBERS);
+
+		for (unsigned long i = 0; i < CACHED_NUMBERS; i++)
+		{
+			numbers.push_back(QString::number(i));
+		}
+	}
+
+	return numbers[value];
+}
+
+//========================================================================================================================
+const DcmStringPool::Descriptor& DcmStringPool::descriptor(const DcmTagKey& tag, const DcmEVR vr)
+{
+	const unsigned long long key = (OFstatic_cast(unsigned long long, tag.getGroup()) << 32) | (OFstatic_cast(unsigned long long, tag.getElement()) << 16) | OFstatic_cast(unsigned int, vr);
+	std::lock_guard<std::mutex> lock(mutex);
+	const auto found = descriptors.find(key);
+
+	if (found != descriptors.end())
+	{
+		return found->second;
+	}
+
+	const DcmVR vrName(vr);
+	Descriptor descriptor;
+	descriptor.tag = QString(tag.toString().c_str()).toUpper();
+
+	if (strcmp(vrName.getVRName(), "??") != 0)
+	{
+		descriptor.vr = vrName.getVRName();
+		descriptor.description = DcmTag(tag).getTagName();
+	}
+
+	return descriptors.emplace(key, descriptor).first->second;
+}
+
+//========================================================================================================================
+size_t DcmStringPool::size()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return strings.size() + descriptors.size() + numbers.size();
+}
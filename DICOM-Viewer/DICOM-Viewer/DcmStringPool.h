@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QString>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "dcmtk/dcmdata/dctagkey.h"
+#include "dcmtk/dcmdata/dcvr.h"
+
+class DcmStringPool
+{
+	public:
+		struct Descriptor
+		{
+			QString tag;
+			QString vr;
+			QString description;
+		};
+
+		static QString intern(const QString& value);
+		static QString number(unsigned long value);
+		static const Descriptor& descriptor(const DcmTagKey& tag, DcmEVR vr);
+		static size_t size();
+
+	private:
+		struct Hash
+		{
+			size_t operator()(const QString& value) const { return qHash(value); }
+		};
+
+		static std::mutex mutex;
+		static std::unordered_map<QString, QString, Hash> strings;
+		static std::unordered_map<unsigned long long, Descriptor> descriptors;
+		static std::vector<QString> numbers;
+};
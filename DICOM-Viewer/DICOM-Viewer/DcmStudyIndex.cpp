@@ -0,0 +1,562 @@
+#include "DcmStudyIndex.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QThread>
+#include "DcmStreamParser.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcdicdir.h"
+
+// the parser stops at the first top level tag past this one, so pixel data is never touched
+#define LAST_INDEXED_TAG DCM_InstanceNumber
+#define INDEX_VERSION 1
+
+class DcmStudyIndexTask final : public QRunnable
+{
+	public:
+		DcmStudyIndexTask(DcmStudyIndex* index, const QString& fileName) : index(index), fileName(fileName) { }
+
+		void run() override
+		{
+			this->index->processFile(this->fileName);
+		}
+
+	private:
+		DcmStudyIndex* index;
+		QString fileName;
+};
+
+class DcmStudyRefreshTask final : public QRunnable
+{
+	public:
+		explicit DcmStudyRefreshTask(DcmStudyIndex* index) : index(index) { }
+
+		void run() override
+		{
+			this->index->walkFolder();
+		}
+
+	private:
+		DcmStudyIndex* index;
+};
+
+class DcmHeaderCollector final : public DcmStreamHandler
+{
+	public:
+		explicit DcmHeaderCollector(DcmStudyIndex::Record& record) : record(record) { }
+
+		bool onEvent(const DcmStreamEvent& event) override
+		{
+			if (event.depth != 0 || event.tag.getGroup() == 0x0002)
+			{
+				return true;
+			}
+
+			if (event.tag > LAST_INDEXED_TAG)
+			{
+				return false;
+			}
+
+			if (event.kind != DcmStreamEvent::Kind::Element || !event.value)
+			{
+				return true;
+			}
+
+			const QString value = QString::fromLatin1(event.value->c_str()).trimmed();
+			this->found = true;
+
+			if (event.tag == DCM_PatientID)
+				this->record.patientId = value;
+			else if (event.tag == DCM_PatientName)
+				this->record.patientName = value;
+			else if (event.tag == DCM_PatientBirthDate)
+				this->record.patientBirthDate = value;
+			else if (event.tag == DCM_StudyInstanceUID)
+				this->record.studyUid = value;
+			else if (event.tag == DCM_StudyDate)
+				this->record.studyDate = value;
+			else if (event.tag == DCM_StudyDescription)
+				this->record.studyDescription = value;
+			else if (event.tag == DCM_AccessionNumber)
+				this->record.accessionNumber = value;
+			else if (event.tag == DCM_SeriesInstanceUID)
+				this->record.seriesUid = value;
+			else if (event.tag == DCM_SeriesDescription)
+				this->record.seriesDescription = value;
+			else if (event.tag == DCM_Modality)
+				this->record.modality = value;
+			else if (event.tag == DCM_SeriesNumber)
+				this->record.seriesNumber = value.toInt();
+			else if (event.tag == DCM_SOPInstanceUID)
+				this->record.sopInstanceUid = value;
+			else if (event.tag == DCM_InstanceNumber)
+				this->record.instanceNumber = value.toInt();
+
+			return true;
+		}
+
+		bool found = false;
+
+	private:
+		DcmStudyIndex::Record& record;
+};
+
+//========================================================================================================================
+DcmStudyIndex::DcmStudyIndex(QObject* parent) : QObject(parent)
+{
+}
+
+//========================================================================================================================
+DcmStudyIndex::~DcmStudyIndex()
+{
+	this->cancel();
+	this->pool.waitForDone();
+}
+
+//========================================================================================================================
+QString DcmStudyIndex::indexFileName(const QString& folder)
+{
+	const QByteArray hash = QCryptographicHash::hash(QDir(folder).absolutePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/index-" + QString::fromLatin1(hash) + ".json";
+}
+
+//========================================================================================================================
+bool DcmStudyIndex::load(const QString& folder)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->folder = QDir(folder).absolutePath();
+	this->records.clear();
+
+	if (this->loadJson(indexFileName(this->folder)))
+	{
+		return true;
+	}
+
+	const QString dicomDir = QDir(this->folder).filePath("DICOMDIR");
+	return QFileInfo::exists(dicomDir) && this->loadDicomDir(dicomDir);
+}
+
+//========================================================================================================================
+bool DcmStudyIndex::loadJson(const QString& fileName)
+{
+	QFile file(fileName);
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		return false;
+	}
+
+	const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+
+	if (root.value("version").toInt() != INDEX_VERSION || root.value("folder").toString() != this->folder)
+	{
+		return false;
+	}
+
+	for (const auto& value : root.value("instances").toArray())
+	{
+		const QJsonObject object = value.toObject();
+		Record record;
+		record.fileName = object.value("file").toString();
+		record.size = static_cast<qint64>(object.value("size").toDouble());
+		record.modified = static_cast<qint64>(object.value("modified").toDouble());
+		record.patientId = object.value("patientId").toString();
+		record.patientName = object.value("patientName").toString();
+		record.patientBirthDate = object.value("patientBirthDate").toString();
+		record.studyUid = object.value("studyUid").toString();
+		record.studyDate = object.value("studyDate").toString();
+		record.studyDescription = object.value("studyDescription").toString();
+		record.accessionNumber = object.value("accessionNumber").toString();
+		record.seriesUid = object.value("seriesUid").toString();
+		record.seriesDescription = object.value("seriesDescription").toString();
+		record.modality = object.value("modality").toString();
+		record.seriesNumber = object.value("seriesNumber").toInt();
+		record.sopInstanceUid = object.value("sopInstanceUid").toString();
+		record.instanceNumber = object.value("instanceNumber").toInt();
+		this->records[record.fileName] = record;
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+bool DcmStudyIndex::loadDicomDir(const QString& fileName)
+{
+	DcmDicomDir dicomDir(QFile::encodeName(fileName).constData());
+
+	if (dicomDir.error().bad())
+	{
+		return false;
+	}
+
+	const QDir base = QFileInfo(fileName).absoluteDir();
+	DcmDirectoryRecord& root = dicomDir.getRootRecord();
+	const auto text = [](DcmDirectoryRecord* record, const DcmTagKey& tag)
+	{
+		OFString value;
+		record->findAndGetOFStringArray(tag, value);
+		return QString::fromLatin1(value.c_str()).trimmed();
+	};
+
+	for (DcmDirectoryRecord* patient = root.nextSub(nullptr); patient; patient = root.nextSub(patient))
+	{
+		for (DcmDirectoryRecord* study = patient->nextSub(nullptr); study && patient->getRecordType() == ERT_Patient; study = patient->nextSub(study))
+		{
+			for (DcmDirectoryRecord* series = study->nextSub(nullptr); series && study->getRecordType() == ERT_Study; series = study->nextSub(series))
+			{
+				for (DcmDirectoryRecord* image = series->nextSub(nullptr); image && series->getRecordType() == ERT_Series; image = series->nextSub(image))
+				{
+					const QString referenced = text(image, DCM_ReferencedFileID).replace('\\', '/');
+
+					if (referenced.isEmpty())
+					{
+						continue;
+					}
+
+					Record record;
+					const QFileInfo info(base.filePath(referenced));
+					record.fileName = info.absoluteFilePath();
+					record.size = info.size();
+					record.modified = info.lastModified().toMSecsSinceEpoch();
+					record.patientId = text(patient, DCM_PatientID);
+					record.patientName = text(patient, DCM_PatientName);
+					record.patientBirthDate = text(patient, DCM_PatientBirthDate);
+					record.studyUid = text(study, DCM_StudyInstanceUID);
+					record.studyDate = text(study, DCM_StudyDate);
+					record.studyDescription = text(study, DCM_StudyDescription);
+					record.accessionNumber = text(study, DCM_AccessionNumber);
+					record.seriesUid = text(series, DCM_SeriesInstanceUID);
+					record.seriesDescription = text(series, DCM_SeriesDescription);
+					record.modality = text(series, DCM_Modality);
+					record.seriesNumber = text(series, DCM_SeriesNumber).toInt();
+					record.sopInstanceUid = text(image, DCM_ReferencedSOPInstanceUIDInFile);
+					record.instanceNumber = text(image, DCM_InstanceNumber).toInt();
+					this->records[record.fileName] = record;
+				}
+			}
+		}
+	}
+
+	return !this->records.empty();
+}
+
+//========================================================================================================================
+void DcmStudyIndex::start(const QString& folder, const int threads)
+{
+	QStringList files;
+	QDirIterator iterator(folder, QDir::Files, QDirIterator::Subdirectories);
+
+	while (iterator.hasNext())
+	{
+		const QString fileName = iterator.next();
+
+		if (QFileInfo(fileName).fileName() != "DICOMDIR")
+		{
+			files.append(fileName);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->folder = QDir(folder).absolutePath();
+		this->records.clear();
+	}
+
+	this->done = 0;
+	this->cancelled = false;
+	this->incremental = false;
+	this->total = files.size();
+	this->pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+
+	if (files.empty())
+	{
+		emit finished();
+		return;
+	}
+
+	for (const auto& file : files)
+	{
+		this->pool.start(new DcmStudyIndexTask(this, file));
+	}
+}
+
+//========================================================================================================================
+void DcmStudyIndex::update(const QStringList& files)
+{
+	QStringList scan;
+	QStringList gone;
+	QSet<QString> seen;
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		for (const auto& file : files)
+		{
+			const QFileInfo info(file);
+			const QString fileName = info.absoluteFilePath();
+			const auto found = this->records.find(fileName);
+
+			if (!info.exists())
+			{
+				if (found != this->records.end())
+				{
+					this->records.erase(found);
+					gone.append(fileName);
+				}
+			}
+
+			// unchanged size and time means the header cannot have changed either
+			else if (found == this->records.end() || found->second.size != info.size() || found->second.modified != info.lastModified().toMSecsSinceEpoch())
+			{
+				if (!seen.contains(fileName) && info.fileName() != "DICOMDIR")
+				{
+					seen.insert(fileName);
+					scan.append(fileName);
+				}
+			}
+		}
+	}
+
+	if (scan.empty())
+	{
+		if (!gone.empty())
+		{
+			emit updated(QStringList(), gone);
+		}
+
+		return;
+	}
+
+	this->changed.clear();
+	this->removed = gone;
+	this->done = 0;
+	this->cancelled = false;
+	this->incremental = true;
+	this->total = scan.size();
+
+	for (const auto& file : scan)
+	{
+		this->pool.start(new DcmStudyIndexTask(this, file));
+	}
+}
+
+//========================================================================================================================
+void DcmStudyIndex::refresh()
+{
+	if (this->isRunning())
+	{
+		return;
+	}
+
+	// listing and stat'ing a large folder takes seconds, the walk runs on the pool and update() continues from there
+	this->cancelled = false;
+	this->refreshing = true;
+	this->pool.start(new DcmStudyRefreshTask(this));
+}
+
+//========================================================================================================================
+void DcmStudyIndex::walkFolder()
+{
+	QStringList files;
+	QDirIterator iterator(this->getFolder(), QDir::Files, QDirIterator::Subdirectories);
+
+	while (iterator.hasNext() && !this->cancelled)
+	{
+		files.append(iterator.next());
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		for (const auto& entry : this->records)
+		{
+			files.append(entry.first);
+		}
+	}
+
+	if (!this->cancelled)
+	{
+		this->update(files);
+	}
+
+	this->refreshing = false;
+}
+
+//========================================================================================================================
+void DcmStudyIndex::cancel()
+{
+	this->cancelled = true;
+}
+
+//========================================================================================================================
+bool DcmStudyIndex::isRunning() const
+{
+	return this->refreshing || this->done < this->total;
+}
+
+//========================================================================================================================
+void DcmStudyIndex::processFile(const QString& fileName)
+{
+	Record record;
+
+	if (!this->cancelled && scanFile(fileName, record))
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->records[record.fileName] = record;
+
+		if (this->incremental)
+		{
+			this->changed.append(record.fileName);
+		}
+	}
+
+	// a file that stopped parsing is dropped, e.g. one being overwritten
+	else if (this->incremental)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		if (this->records.erase(fileName))
+		{
+			this->removed.append(fileName);
+		}
+	}
+
+	const int current = ++this->done;
+	emit progress(current, this->total);
+
+	if (current == this->total)
+	{
+		if (this->incremental)
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			emit updated(this->changed, this->removed);
+		}
+
+		else
+		{
+			emit finished();
+		}
+	}
+}
+
+//========================================================================================================================
+bool DcmStudyIndex::scanFile(const QString& fileName, Record& record)
+{
+	const QFileInfo info(fileName);
+	DcmHeaderCollector collector(record);
+	DcmStreamParser parser;
+	parser.setPreviewLength(324);
+
+	if (!parser.parseFile(QFile::encodeName(fileName).toStdString(), collector) || !collector.found || record.sopInstanceUid.isEmpty())
+	{
+		return false;
+	}
+
+	record.fileName = info.absoluteFilePath();
+	record.size = info.size();
+	record.modified = info.lastModified().toMSecsSinceEpoch();
+	return true;
+}
+
+//========================================================================================================================
+bool DcmStudyIndex::save() const
+{
+	QJsonArray instances;
+	QString folder;
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		folder = this->folder;
+
+		for (const auto& entry : this->records)
+		{
+			const Record& record = entry.second;
+			QJsonObject object;
+			object.insert("file", record.fileName);
+			object.insert("size", static_cast<double>(record.size));
+			object.insert("modified", static_cast<double>(record.modified));
+			object.insert("patientId", record.patientId);
+			object.insert("patientName", record.patientName);
+			object.insert("patientBirthDate", record.patientBirthDate);
+			object.insert("studyUid", record.studyUid);
+			object.insert("studyDate", record.studyDate);
+			object.insert("studyDescription", record.studyDescription);
+			object.insert("accessionNumber", record.accessionNumber);
+			object.insert("seriesUid", record.seriesUid);
+			object.insert("seriesDescription", record.seriesDescription);
+			object.insert("modality", record.modality);
+			object.insert("seriesNumber", record.seriesNumber);
+			object.insert("sopInstanceUid", record.sopInstanceUid);
+			object.insert("instanceNumber", record.instanceNumber);
+			instances.append(object);
+		}
+	}
+
+	if (folder.isEmpty())
+	{
+		return false;
+	}
+
+	QJsonObject root;
+	root.insert("version", INDEX_VERSION);
+	root.insert("folder", folder);
+	root.insert("instances", instances);
+
+	const QString fileName = indexFileName(folder);
+	QDir().mkpath(QFileInfo(fileName).absolutePath());
+	QSaveFile file(fileName);
+
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		return false;
+	}
+
+	file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+	return file.commit();
+}
+
+//========================================================================================================================
+QString DcmStudyIndex::getFolder() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->folder;
+}
+
+//========================================================================================================================
+std::vector<DcmStudyIndex::Record> DcmStudyIndex::getRecords() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::vector<Record> result;
+	result.reserve(this->records.size());
+
+	for (const auto& entry : this->records)
+	{
+		result.push_back(entry.second);
+	}
+
+	return result;
+}
+
+//========================================================================================================================
+bool DcmStudyIndex::getRecord(const QString& fileName, Record& record) const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	const auto found = this->records.find(fileName);
+
+	if (found == this->records.end())
+	{
+		return false;
+	}
+
+	record = found->second;
+	return true;
+}
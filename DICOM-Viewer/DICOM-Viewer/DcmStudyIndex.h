@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+class DcmStudyIndex final : public QObject
+{
+	Q_OBJECT
+
+	public:
+		struct Record
+		{
+			QString fileName;
+			qint64 size = 0;
+			qint64 modified = 0;
+			QString patientId;
+			QString patientName;
+			QString patientBirthDate;
+			QString studyUid;
+			QString studyDate;
+			QString studyDescription;
+			QString accessionNumber;
+			QString seriesUid;
+			QString seriesDescription;
+			QString modality;
+			int seriesNumber = 0;
+			QString sopInstanceUid;
+			int instanceNumber = 0;
+		};
+
+		explicit DcmStudyIndex(QObject* parent = nullptr);
+		~DcmStudyIndex();
+
+		bool load(const QString& folder);
+		void start(const QString& folder, int threads);
+		void update(const QStringList& files);
+		void refresh();
+		void cancel();
+		bool isRunning() const;
+		bool save() const;
+		QString getFolder() const;
+		std::vector<Record> getRecords() const;
+		bool getRecord(const QString& fileName, Record& record) const;
+		void processFile(const QString& fileName);
+		void walkFolder();
+		static bool scanFile(const QString& fileName, Record& record);
+		static QString indexFileName(const QString& folder);
+
+	signals:
+		void progress(int done, int total);
+		void finished();
+		void updated(const QStringList& changed, const QStringList& removed);
+
+	private:
+		QThreadPool pool;
+		QString folder;
+		mutable std::mutex mutex;
+		std::map<QString, Record> records;
+		std::atomic<int> done{ 0 };
+		std::atomic<bool> cancelled{ false };
+		std::atomic<bool> refreshing{ false };
+		std::atomic<int> total{ 0 };
+		bool incremental = false;
+		QStringList changed;
+		QStringList removed;
+
+		bool loadJson(const QString& fileName);
+		bool loadDicomDir(const QString& fileName);
+};
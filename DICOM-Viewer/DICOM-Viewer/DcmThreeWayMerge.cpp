@@ -0,0 +1,390 @@
+#include "DcmThreeWayMerge.h"
+#include <QFile>
+#include <cstring>
+#include "DcmFastSave.h"
+#include "DcmValueFormatter.h"
+#include "dcmtk/dcmdata/dcitem.h"
+#include "dcmtk/dcmdata/dcpixel.h"
+#include "dcmtk/dcmdata/dcpixseq.h"
+#include "dcmtk/dcmdata/dcpxitem.h"
+#include "dcmtk/dcmdata/dcsequen.h"
+#include "dcmtk/dcmdata/dcxfer.h"
+
+static QString tagText(const DcmTagKey& tag)
+{
+	return QString("(%1,%2)").arg(tag.getGroup(), 4, 16, QChar('0')).arg(tag.getElement(), 4, 16, QChar('0')).toUpper();
+}
+
+static bool isSequence(DcmElement* element)
+{
+	return element && element->ident() == EVR_SQ;
+}
+
+//========================================================================================================================
+bool DcmThreeWayMerge::load(const QString& base, const QString& ours, const QString& theirs, QString& error)
+{
+	this->conflicts.clear();
+	this->touched.clear();
+	this->applied = 0;
+
+	const std::pair<DcmFileFormat*, const QString*> files[] = { { &this->base, &base }, { &this->ours, &ours }, { &this->theirs, &theirs } };
+
+	for (const auto& file : files)
+	{
+		const OFCondition cond = file.first->loadFile(QFile::encodeName(*file.second).constData());
+
+		if (cond.bad())
+		{
+			error = "Failed to open " + *file.second + ": " + cond.text();
+			return false;
+		}
+	}
+
+	this->oursFileName = ours;
+	return true;
+}
+
+//========================================================================================================================
+void DcmThreeWayMerge::merge()
+{
+	this->conflicts.clear();
+	this->touched.clear();
+	this->applied = 0;
+
+	// the result starts as our version, changes made only on their side are carried over
+	this->merged = this->ours;
+	this->mergeItem(this->base.getDataset(), this->ours.getDataset(), this->theirs.getDataset(), this->merged.getDataset(), QString(), nullptr);
+}
+
+//========================================================================================================================
+void DcmThreeWayMerge::mergeItem(DcmItem* base, DcmItem* ours, DcmItem* theirs, DcmItem* target, const QString& path, const DcmTagKey* topLevel)
+{
+	// elements are kept sorted by tag, so a single interleaved walk lines up all three versions
+	auto* nextBase = OFstatic_cast(DcmElement*, base->nextInContainer(nullptr));
+	auto* nextOurs = OFstatic_cast(DcmElement*, ours->nextInContainer(nullptr));
+	auto* nextTheirs = OFstatic_cast(DcmElement*, theirs->nextInContainer(nullptr));
+
+	while (nextBase || nextOurs || nextTheirs)
+	{
+		DcmTagKey tag(0xFFFF, 0xFFFF);
+
+		for (const DcmElement* element : { nextBase, nextOurs, nextTheirs })
+		{
+			if (element && element->getTag().getBaseTag() < tag)
+			{
+				tag = element->getTag().getBaseTag();
+			}
+		}
+
+		DcmElement* elementBase = nextBase && nextBase->getTag().getBaseTag() == tag ? nextBase : nullptr;
+		DcmElement* elementOurs = nextOurs && nextOurs->getTag().getBaseTag() == tag ? nextOurs : nullptr;
+		DcmElement* elementTheirs = nextTheirs && nextTheirs->getTag().getBaseTag() == tag ? nextTheirs : nullptr;
+
+		if (elementBase)
+		{
+			nextBase = OFstatic_cast(DcmElement*, base->nextInContainer(elementBase));
+		}
+
+		if (elementOurs)
+		{
+			nextOurs = OFstatic_cast(DcmElement*, ours->nextInContainer(elementOurs));
+		}
+
+		if (elementTheirs)
+		{
+			nextTheirs = OFstatic_cast(DcmElement*, theirs->nextInContainer(elementTheirs));
+		}
+
+		this->mergeElement(elementBase, elementOurs, elementTheirs, tag, target, path, topLevel ? *topLevel : tag);
+	}
+}
+
+//========================================================================================================================
+void DcmThreeWayMerge::mergeElement(DcmElement* base, DcmElement* ours, DcmElement* theirs, const DcmTagKey& tag, DcmItem* target, const QString& path, const DcmTagKey& topLevel)
+{
+	const QString elementPath = path + (path.isEmpty() ? "" : ".") + tagText(tag);
+
+	// sequences with the same item count on all sides are merged item by item, anything else is one unit
+	if (isSequence(base) && isSequence(ours) && isSequence(theirs))
+	{
+		auto* sequenceBase = OFstatic_cast(DcmSequenceOfItems*, base);
+		auto* sequenceOurs = OFstatic_cast(DcmSequenceOfItems*, ours);
+		auto* sequenceTheirs = OFstatic_cast(DcmSequenceOfItems*, theirs);
+		DcmSequenceOfItems* sequenceTarget = nullptr;
+
+		if (sequenceBase->card() == sequenceOurs->card() && sequenceBase->card() == sequenceTheirs->card()
+			&& target->findAndGetSequence(tag, sequenceTarget, OFFalse).good() && sequenceTarget)
+		{
+			DcmObject* itemBase = nullptr;
+			DcmObject* itemOurs = nullptr;
+			DcmObject* itemTheirs = nullptr;
+			DcmObject* itemTarget = nullptr;
+
+			for (unsigned long i = 0; i < sequenceBase->card(); i++)
+			{
+				itemBase = sequenceBase->nextInContainer(itemBase);
+				itemOurs = sequenceOurs->nextInContainer(itemOurs);
+				itemTheirs = sequenceTheirs->nextInContainer(itemTheirs);
+				itemTarget = sequenceTarget->nextInContainer(itemTarget);
+				this->mergeItem(OFstatic_cast(DcmItem*, itemBase), OFstatic_cast(DcmItem*, itemOurs), OFstatic_cast(DcmItem*, itemTheirs), OFstatic_cast(DcmItem*, itemTarget),
+					elementPath + "[" + QString::number(i + 1) + "]", &topLevel);
+			}
+
+			return;
+		}
+	}
+
+	if (same(base, theirs) || same(ours, theirs))
+	{
+		return;
+	}
+
+	if (same(base, ours))
+	{
+		replace(target, tag, theirs);
+		this->touched.insert(topLevel);
+		this->applied++;
+		return;
+	}
+
+	this->conflicts.push_back(Conflict{ elementPath, tag, topLevel, target, base, ours, theirs, Resolution::Ours });
+}
+
+//========================================================================================================================
+void DcmThreeWayMerge::resolve(const size_t index, const Resolution resolution)
+{
+	Conflict& conflict = this->conflicts[index];
+	conflict.resolution = resolution;
+	replace(conflict.target, conflict.tag, resolution == Resolution::Ours ? conflict.ours : resolution == Resolution::Theirs ? conflict.theirs : conflict.base);
+	this->touched.insert(conflict.topLevel);
+}
+
+//========================================================================================================================
+OFCondition DcmThreeWayMerge::save(const QString& fileName)
+{
+	// top level elements nobody touched are copied byte for byte from our file
+	DcmFastSave fastSave;
+	fastSave.setSource(&this->merged, QFile::encodeName(this->oursFileName).toStdString());
+
+	for (const auto& tag : this->touched)
+	{
+		fastSave.markDirty(tag);
+	}
+
+	return fastSave.saveFile(QFile::encodeName(fileName).toStdString());
+}
+
+//========================================================================================================================
+const std::vector<DcmThreeWayMerge::Conflict>& DcmThreeWayMerge::getConflicts() const
+{
+	return this->conflicts;
+}
+
+//========================================================================================================================
+int DcmThreeWayMerge::getApplied() const
+{
+	return this->applied;
+}
+
+//========================================================================================================================
+QString DcmThreeWayMerge::describe(DcmElement* element)
+{
+	if (!element)
+	{
+		return "<absent>";
+	}
+
+	if (isSequence(element))
+	{
+		return "Sequence, " + QString::number(OFstatic_cast(DcmSequenceOfItems*, element)->card()) + " items";
+	}
+
+	return DcmValueFormatter::preview(element);
+}
+
+//========================================================================================================================
+void DcmThreeWayMerge::replace(DcmItem* target, const DcmTagKey& tag, DcmElement* source)
+{
+	if (!source)
+	{
+		target->findAndDeleteElement(tag);
+		return;
+	}
+
+	target->insert(OFstatic_cast(DcmElement*, source->clone()), OFTrue);
+}
+
+//========================================================================================================================
+bool DcmThreeWayMerge::same(DcmElement* first, DcmElement* second)
+{
+	if (!first || !second)
+	{
+		return first == second;
+	}
+
+	if (first->ident() != second->ident())
+	{
+		return false;
+	}
+
+	if (isSequence(first))
+	{
+		auto* sequenceFirst = OFstatic_cast(DcmSequenceOfItems*, first);
+		auto* sequenceSecond = OFstatic_cast(DcmSequenceOfItems*, second);
+
+		if (sequenceFirst->card() != sequenceSecond->card())
+		{
+			return false;
+		}
+
+		DcmObject* itemFirst = nullptr;
+		DcmObject* itemSecond = nullptr;
+
+		for (unsigned long i = 0; i < sequenceFirst->card(); i++)
+		{
+			itemFirst = sequenceFirst->nextInContainer(itemFirst);
+			itemSecond = sequenceSecond->nextInContainer(itemSecond);
+
+			if (!sameItem(OFstatic_cast(DcmItem*, itemFirst), OFstatic_cast(DcmItem*, itemSecond)))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	const Uint32 length = first->getLength();
+
+	if (length != second->getLength())
+	{
+		return false;
+	}
+
+	if (length == 0)
+	{
+		return true;
+	}
+
+	const DcmEVR vr = first->ident();
+
+	// binary values are compared as raw bytes, encapsulated pixel data fragment by fragment
+	if (vr == EVR_OB || vr == EVR_OW || vr == EVR_UN || vr == EVR_ox || vr == EVR_PixelData)
+	{
+		DcmPixelSequence* fragmentsFirst = pixelSequence(first);
+		DcmPixelSequence* fragmentsSecond = pixelSequence(second);
+
+		if (fragmentsFirst || fragmentsSecond)
+		{
+			return fragmentsFirst && fragmentsSecond && sameFragments(fragmentsFirst, fragmentsSecond);
+		}
+
+		Uint8* bytesFirst = nullptr;
+		Uint8* bytesSecond = nullptr;
+		Uint16* wordsFirst = nullptr;
+		Uint16* wordsSecond = nullptr;
+
+		if (first->getUint8Array(bytesFirst).good() && second->getUint8Array(bytesSecond).good() && bytesFirst && bytesSecond)
+		{
+			return std::memcmp(bytesFirst, bytesSecond, length) == 0;
+		}
+
+		if (first->getUint16Array(wordsFirst).good() && second->getUint16Array(wordsSecond).good() && wordsFirst && wordsSecond)
+		{
+			return std::memcmp(wordsFirst, wordsSecond, length) == 0;
+		}
+
+		// a value that cannot be read is never assumed to be unchanged
+		return false;
+	}
+
+	OFString valueFirst;
+	OFString valueSecond;
+	first->getOFStringArray(valueFirst);
+	second->getOFStringArray(valueSecond);
+	return valueFirst == valueSecond;
+}
+
+//========================================================================================================================
+DcmPixelSequence* DcmThreeWayMerge::pixelSequence(DcmElement* element)
+{
+	if (element->ident() != EVR_PixelData)
+	{
+		return nullptr;
+	}
+
+	auto* pixelData = OFstatic_cast(DcmPixelData*, element);
+	E_TransferSyntax xfer = EXS_Unknown;
+	const DcmRepresentationParameter* param = nullptr;
+	DcmPixelSequence* fragments = nullptr;
+	pixelData->getOriginalRepresentationKey(xfer, param);
+
+	if (!DcmXfer(xfer).isEncapsulated() || pixelData->getEncapsulatedRepresentation(xfer, param, fragments).bad())
+	{
+		return nullptr;
+	}
+
+	return fragments;
+}
+
+//========================================================================================================================
+bool DcmThreeWayMerge::sameFragments(DcmPixelSequence* first, DcmPixelSequence* second)
+{
+	if (first->card() != second->card())
+	{
+		return false;
+	}
+
+	// the offset table is the first fragment, it is compared like any other
+	for (unsigned long i = 0; i < first->card(); i++)
+	{
+		DcmPixelItem* itemFirst = nullptr;
+		DcmPixelItem* itemSecond = nullptr;
+		Uint8* bytesFirst = nullptr;
+		Uint8* bytesSecond = nullptr;
+
+		if (first->getItem(itemFirst, i).bad() || second->getItem(itemSecond, i).bad() || itemFirst->getLength() != itemSecond->getLength())
+		{
+			return false;
+		}
+
+		if (itemFirst->getLength() == 0)
+		{
+			continue;
+		}
+
+		if (itemFirst->getUint8Array(bytesFirst).bad() || itemSecond->getUint8Array(bytesSecond).bad() || !bytesFirst || !bytesSecond
+			|| std::memcmp(bytesFirst, bytesSecond, itemFirst->getLength()) != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//========================================================================================================================
+bool DcmThreeWayMerge::sameItem(DcmItem* first, DcmItem* second)
+{
+	if (first->card() != second->card())
+	{
+		return false;
+	}
+
+	DcmObject* elementFirst = nullptr;
+	DcmObject* elementSecond = nullptr;
+
+	for (unsigned long i = 0; i < first->card(); i++)
+	{
+		elementFirst = first->nextInContainer(elementFirst);
+		elementSecond = second->nextInContainer(elementSecond);
+
+		if (OFstatic_cast(DcmElement*, elementFirst)->getTag() != OFstatic_cast(DcmElement*, elementSecond)->getTag()
+			|| !same(OFstatic_cast(DcmElement*, elementFirst), OFstatic_cast(DcmElement*, elementSecond)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QString>
+#include <set>
+#include <vector>
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dctagkey.h"
+
+class DcmPixelSequence;
+
+class DcmThreeWayMerge
+{
+	public:
+		enum class Resolution
+		{
+			Ours,
+			Theirs,
+			Base
+		};
+
+		struct Conflict
+		{
+			QString path;
+			DcmTagKey tag;
+			DcmTagKey topLevel;
+			DcmItem* target;
+			DcmElement* base;
+			DcmElement* ours;
+			DcmElement* theirs;
+			Resolution resolution;
+		};
+
+		bool load(const QString& base, const QString& ours, const QString& theirs, QString& error);
+		void merge();
+		void resolve(size_t index, Resolution resolution);
+		OFCondition save(const QString& fileName);
+		const std::vector<Conflict>& getConflicts() const;
+		int getApplied() const;
+		static QString describe(DcmElement* element);
+		static bool same(DcmElement* first, DcmElement* second);
+
+	private:
+		DcmFileFormat base;
+		DcmFileFormat ours;
+		DcmFileFormat theirs;
+		DcmFileFormat merged;
+		QString oursFileName;
+		std::vector<Conflict> conflicts;
+		std::set<DcmTagKey> touched;
+		int applied = 0;
+
+		void mergeItem(DcmItem* base, DcmItem* ours, DcmItem* theirs, DcmItem* target, const QString& path, const DcmTagKey* topLevel);
+		void mergeElement(DcmElement* base, DcmElement* ours, DcmElement* theirs, const DcmTagKey& tag, DcmItem* target, const QString& path, const DcmTagKey& topLevel);
+		static void replace(DcmItem* target, const DcmTagKey& tag, DcmElement* source);
+		static bool sameItem(DcmItem* first, DcmItem* second);
+		static bool sameFragments(DcmPixelSequence* first, DcmPixelSequence* second);
+		static DcmPixelSequence* pixelSequence(DcmElement* element);
+};
@@ -0,0 +1,172 @@
+#include "DcmTriage.h"
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QFile>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include "DcmCompareReport.h"
+#include "DcmStreamParser.h"
+
+#define TRIAGE_FLAG "--triage"
+
+class DcmTriageTask final : public QRunnable
+{
+	public:
+		DcmTriageTask(DcmTriage* triage, const QString& fileName) : triage(triage), fileName(fileName) { }
+
+		void run() override
+		{
+			this->triage->triageFile(this->fileName);
+		}
+
+	private:
+		DcmTriage* triage;
+		QString fileName;
+};
+
+class DcmTriageCounter final : public DcmStreamHandler
+{
+	public:
+		unsigned long elements = 0;
+
+		bool onEvent(const DcmStreamEvent& event) override
+		{
+			if (event.kind == DcmStreamEvent::Kind::Element || event.kind == DcmStreamEvent::Kind::SequenceStart)
+			{
+				this->elements++;
+			}
+
+			return true;
+		}
+};
+
+//========================================================================================================================
+DcmTriage::DcmTriage(const Options& options) : options(options)
+{
+}
+
+//========================================================================================================================
+bool DcmTriage::isRequested(const QStringList& arguments)
+{
+	return arguments.contains(TRIAGE_FLAG);
+}
+
+//========================================================================================================================
+bool DcmTriage::parseArguments(const QStringList& arguments, Options& options)
+{
+	QCommandLineParser parser;
+	parser.addOption(QCommandLineOption("triage", "Folder to scan for damaged files.", "folder"));
+	parser.addOption(QCommandLineOption("output", "JSON lines output file.", "file"));
+	parser.addOption(QCommandLineOption("threads", "Worker threads, 0 for one per core.", "count", "0"));
+
+	if (!parser.parse(arguments))
+	{
+		std::cerr << parser.errorText().toStdString() << std::endl;
+		return false;
+	}
+
+	options.folder = parser.value("triage");
+	options.output = parser.value("output");
+	options.threads = parser.value("threads").toInt();
+	return true;
+}
+
+//========================================================================================================================
+int DcmTriage::run(const QStringList& arguments)
+{
+	Options options;
+
+	// exit codes follow --compare: 0 all files clean, 1 damaged or unreadable files found, 2 the triage itself failed
+	if (!parseArguments(arguments, options))
+	{
+		return 2;
+	}
+
+	DcmTriage triage(options);
+
+	if (!options.output.isEmpty())
+	{
+		triage.file.open(QFile::encodeName(options.output).toStdString(), std::ios::out | std::ios::trunc);
+
+		if (!triage.file)
+		{
+			std::cerr << "Cannot open " << options.output.toStdString() << std::endl;
+			return 2;
+		}
+	}
+
+	QThreadPool pool;
+	pool.setMaxThreadCount(options.threads > 0 ? options.threads : QThread::idealThreadCount());
+	QDirIterator iterator(options.folder, QDir::Files, QDirIterator::Subdirectories);
+	int total = 0;
+
+	while (iterator.hasNext())
+	{
+		pool.start(new DcmTriageTask(&triage, iterator.next()));
+		total++;
+	}
+
+	pool.waitForDone();
+	std::cerr << total << " files, " << triage.damaged << " damaged, " << triage.unreadable << " unreadable" << std::endl;
+	return triage.damaged || triage.unreadable ? 1 : 0;
+}
+
+//========================================================================================================================
+void DcmTriage::triageFile(const QString& fileName)
+{
+	const auto start = std::chrono::steady_clock::now();
+	DcmTriageCounter counter;
+	DcmStreamParser parser;
+	parser.setPreviewLength(0);
+	parser.setTolerant(true);
+
+	const bool parsed = parser.parseFile(QFile::encodeName(fileName).toStdString(), counter);
+	const std::vector<DcmStreamError>& errors = parser.getErrors();
+	const char* status = !parsed ? "unreadable" : errors.empty() ? "ok" : "damaged";
+
+	if (!parsed)
+	{
+		this->unreadable++;
+	}
+
+	else if (!errors.empty())
+	{
+		this->damaged++;
+	}
+
+	std::ostringstream line;
+	line << "{\"file\":\"" << DcmCompareReport::escapeJson(fileName) << "\",\"status\":\"" << status << "\",\"bytes\":" << parser.getFileSize()
+		<< ",\"elements\":" << counter.elements
+		<< ",\"ms\":" << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	if (!parsed)
+	{
+		line << ",\"error\":\"" << DcmCompareReport::escapeJson(QString::fromStdString(parser.getError())) << "\",\"offset\":" << parser.getErrorOffset();
+	}
+
+	line << ",\"regions\":[";
+
+	for (size_t i = 0; i < errors.size(); i++)
+	{
+		line << (i ? "," : "") << "{\"offset\":" << errors[i].offset << ",\"length\":" << errors[i].length << ",\"error\":\"" << DcmCompareReport::escapeJson(QString::fromStdString(errors[i].message)) << "\"}";
+	}
+
+	line << "]}";
+	this->report(line.str());
+}
+
+//========================================================================================================================
+void DcmTriage::report(const std::string& line)
+{
+	std::lock_guard<std::mutex> lock(this->outputMutex);
+	std::cout << line << std::endl;
+
+	if (this->file.is_open())
+	{
+		this->file << line << std::endl;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+class DcmTriage
+{
+	public:
+		struct Options
+		{
+			QString folder;
+			QString output;
+			int threads = 0;
+		};
+
+		static bool isRequested(const QStringList& arguments);
+		static int run(const QStringList& arguments);
+		void triageFile(const QString& fileName);
+
+	private:
+		explicit DcmTriage(const Options& options);
+
+		Options options;
+		std::ofstream file;
+		std::mutex outputMutex;
+		std::atomic<int> damaged{ 0 };
+		std::atomic<int> unreadable{ 0 };
+
+		static bool parseArguments(const QStringList& arguments, Options& options);
+		void report(const std::string& line);
+};
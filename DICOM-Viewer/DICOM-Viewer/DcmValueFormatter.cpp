@@ -0,0 +1,93 @@
+#include "DcmValueFormatter.h"
+#include <limits>
+#include "dcmtk/dcmdata/dcvr.h"
+
+#define PREVIEW_VALUES 16
+#define PREVIEW_LENGTH 256
+#define TOOLTIP_VALUES 512
+#define TOOLTIP_LENGTH 4096
+
+QString DcmValueFormatter::preview(DcmElement* element)
+{
+	return join(element, PREVIEW_VALUES, PREVIEW_LENGTH);
+}
+
+//========================================================================================================================
+QString DcmValueFormatter::tooltip(DcmElement* element)
+{
+	return join(element, TOOLTIP_VALUES, TOOLTIP_LENGTH);
+}
+
+//========================================================================================================================
+QString DcmValueFormatter::full(DcmElement* element)
+{
+	return join(element, std::numeric_limits<unsigned long>::max(), std::numeric_limits<int>::max());
+}
+
+//========================================================================================================================
+QString DcmValueFormatter::page(DcmElement* element, const unsigned long first, const unsigned long count)
+{
+	const unsigned long total = valueCount(element);
+	QString result;
+
+	for (unsigned long i = first; i < total && i < first + count; i++)
+	{
+		OFString value;
+		element->getOFString(value, i, OFTrue);
+		result.append(QString("[%1] ").arg(i)).append(QString::fromLatin1(value.c_str())).append('\n');
+	}
+
+	return result;
+}
+
+//========================================================================================================================
+unsigned long DcmValueFormatter::valueCount(DcmElement* element)
+{
+	if (!element || element->ident() == EVR_SQ || element->ident() == EVR_pixelSQ || element->getLength() == 0 || element->getLength() == DCM_UndefinedLength)
+	{
+		return 0;
+	}
+
+	const DcmVR vr(element->ident());
+
+	if (vr.isaString())
+	{
+		return element->getVM();
+	}
+
+	const Uint32 width = vr.getValueWidth() ? vr.getValueWidth() : 1;
+	return element->getLength() / width;
+}
+
+//========================================================================================================================
+QString DcmValueFormatter::join(DcmElement* element, const unsigned long count, const int maxLength)
+{
+	const unsigned long total = valueCount(element);
+	QString result;
+
+	for (unsigned long i = 0; i < total && i < count; i++)
+	{
+		OFString value;
+		element->getOFString(value, i, OFTrue);
+
+		if (i)
+		{
+			result.append(' ');
+		}
+
+		result.append(QString::fromLatin1(value.c_str()));
+
+		if (result.size() > maxLength)
+		{
+			result.truncate(maxLength);
+			return result.append(" ...");
+		}
+	}
+
+	if (total > count)
+	{
+		result.append(" ...");
+	}
+
+	return result;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QString>
+#include "dcmtk/dcmdata/dcelem.h"
+
+class DcmValueFormatter
+{
+	public:
+		static QString preview(DcmElement* element);
+		static QString tooltip(DcmElement* element);
+		static QString full(DcmElement* element);
+		static QString page(DcmElement* element, unsigned long first, unsigned long count);
+		static unsigned long valueCount(DcmElement* element);
+
+	private:
+		static QString join(DcmElement* element, unsigned long count, int maxLength);
+};
@@ -0,0 +1,54 @@
+#include "DcmValueItem.h"
+#include "DcmValueFormatter.h"
+
+DcmValueItem::DcmValueItem(const DcmWidgetElement& element) : source(element.getSource())
+{
+	if (!this->source)
+	{
+		QTableWidgetItem::setData(Qt::DisplayRole, element.getItemValue());
+	}
+}
+
+//========================================================================================================================
+QVariant DcmValueItem::data(const int role) const
+{
+	if (!this->source)
+	{
+		return QTableWidgetItem::data(role);
+	}
+
+	if (role == Qt::DisplayRole || role == Qt::EditRole)
+	{
+		if (!this->formatted)
+		{
+			this->text = DcmValueFormatter::preview(this->source);
+			this->formatted = true;
+		}
+
+		return this->text;
+	}
+
+	if (role == Qt::ToolTipRole)
+	{
+		return DcmValueFormatter::tooltip(this->source);
+	}
+
+	return QTableWidgetItem::data(role);
+}
+
+//========================================================================================================================
+void DcmValueItem::setData(const int role, const QVariant& value)
+{
+	if (role == Qt::DisplayRole || role == Qt::EditRole)
+	{
+		this->source = nullptr;
+	}
+
+	QTableWidgetItem::setData(role, value);
+}
+
+//========================================================================================================================
+DcmElement* DcmValueItem::getSource() const
+{
+	return this->source;
+}
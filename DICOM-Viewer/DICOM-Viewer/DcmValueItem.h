@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QtWidgets/qtablewidget.h>
+#include "DcmWidgetElement.h"
+
+class DcmValueItem final : public QTableWidgetItem
+{
+	public:
+		explicit DcmValueItem(const DcmWidgetElement& element);
+		~DcmValueItem() = default;
+
+		QVariant data(int role) const override;
+		void setData(int role, const QVariant& value) override;
+		DcmElement* getSource() const;
+
+	private:
+		DcmElement* source = nullptr;
+		mutable QString text;
+		mutable bool formatted = false;
+};
@@ -1,4 +1,5 @@
 #include "DcmWidgetElement.h"
+#include "DcmValueFormatter.h"
 
 DcmWidgetElement::DcmWidgetElement(const QString &itemTag, const QString &itemVR, const QString &itemVM, const QString &itemLength, const QString &itemDescription, const QString &itemValue)
 {
@@ -43,6 +44,12 @@ QString DcmWidgetElement::getItemDescription() const
 //========================================================================================================================
 QString DcmWidgetElement::getItemValue() const
 {
+	if (this->source && !this->formatted)
+	{
+		this->itemValue = DcmValueFormatter::preview(this->source);
+		this->formatted = true;
+	}
+
 	return this->itemValue;
 }
 
@@ -56,7 +63,7 @@ int DcmWidgetElement::getTableIndex() const
 std::string DcmWidgetElement::toString() const
 {
 	return std::string(this->itemTag.toStdString() + " " + this->itemVM.toStdString() + " "+ this->itemVR.toStdString() + " " 
-	+ this->itemLength.toStdString() + " " + this->itemDescription.toStdString() + " " + this->itemValue.toStdString());
+	+ this->itemLength.toStdString() + " " + this->itemDescription.toStdString() + " " + this->getItemValue().toStdString());
 }
 
 //========================================================================================================================
@@ -66,11 +73,11 @@ int DcmWidgetElement::getDepth() const
 }
 
 //========================================================================================================================
-void DcmWidgetElement::calculateTableIndex(const int & current, const std::vector<DcmWidgetElement>& elements)
+void DcmWidgetElement::calculateTableIndex(const int & current, const DcmElementList& elements)
 {
 	int count = 0;
 
-	for (auto element : elements)
+	for (const auto& element : elements)
 	{
 		if (*this == element)
 			count++;
@@ -112,7 +119,7 @@ bool DcmWidgetElement::checkIfContains(const QString& str) const
 {
 	return this->itemTag.toUpper().contains(str.toUpper()) || this->itemVM.toUpper().contains(str.toUpper()) ||
 	this->itemVR.toUpper().contains(str.toUpper()) || this->itemLength.toUpper().contains(str.toUpper()) || 
-	this->itemDescription.toUpper().contains(str.toUpper()) || this->itemValue.toUpper().contains(str.toUpper());
+	this->itemDescription.toUpper().contains(str.toUpper()) || this->getItemValue().toUpper().contains(str.toUpper());
 }
 
 //========================================================================================================================
@@ -152,6 +159,64 @@ void DcmWidgetElement::setVR(const QString& str)
 void DcmWidgetElement::setValue(const QString& str)
 {
 	this->itemValue = str;
+	this->source = nullptr;
+}
+
+//========================================================================================================================
+void DcmWidgetElement::setSource(DcmElement* element)
+{
+	this->source = element;
+	this->formatted = false;
+}
+
+//========================================================================================================================
+DcmElement* DcmWidgetElement::getSource() const
+{
+	return this->source;
+}
+
+//========================================================================================================================
+void DcmWidgetElement::setLocation(const qint64 offset, const quint32 headerLength, const qint64 valueLength)
+{
+	this->offset = offset;
+	this->headerLength = headerLength;
+	this->valueLength = valueLength;
+}
+
+//========================================================================================================================
+qint64 DcmWidgetElement::getOffset() const
+{
+	return this->offset;
+}
+
+//========================================================================================================================
+quint32 DcmWidgetElement::getHeaderLength() const
+{
+	return this->headerLength;
+}
+
+//========================================================================================================================
+qint64 DcmWidgetElement::getValueLength() const
+{
+	return this->valueLength;
+}
+
+//========================================================================================================================
+bool DcmWidgetElement::hasLocation() const
+{
+	return this->offset >= 0;
+}
+
+//========================================================================================================================
+void DcmWidgetElement::setCorrupt(const bool corrupt)
+{
+	this->corrupt = corrupt;
+}
+
+//========================================================================================================================
+bool DcmWidgetElement::isCorrupt() const
+{
+	return this->corrupt;
 }
 
 //========================================================================================================================
@@ -180,7 +245,7 @@ int DcmWidgetElement::hexToDecimal(const char * hex)
 }
 
 //========================================================================================================================
-bool DcmWidgetElement::operator==(DcmWidgetElement & element) const
+bool DcmWidgetElement::operator==(const DcmWidgetElement & element) const
 {
 	return this->getItemTag().replace(" ","") == element.getItemTag().replace(" ","") &&
 		this->getItemVM() == element.getItemVM() &&
@@ -190,19 +255,19 @@ bool DcmWidgetElement::operator==(DcmWidgetElement & element) const
 }
 
 //========================================================================================================================
-bool DcmWidgetElement::operator>(DcmWidgetElement & element) const
+bool DcmWidgetElement::operator>(const DcmWidgetElement & element) const
 {
 	return this->extractTagKey() > element.extractTagKey();
 }
 
 //========================================================================================================================
-bool DcmWidgetElement::operator<(DcmWidgetElement & element) const
+bool DcmWidgetElement::operator<(const DcmWidgetElement & element) const
 {
 	return this->extractTagKey() < element.extractTagKey();
 }
 
 //========================================================================================================================
-int DcmWidgetElement::compareTagKey(DcmWidgetElement & element) const
+int DcmWidgetElement::compareTagKey(const DcmWidgetElement & element) const
 {
 	if (this->extractTagKey() == element.extractTagKey())
 	{
@@ -1,8 +1,14 @@
 #pragma once
 
 #include <QtWidgets>
+#include <memory_resource>
+#include <vector>
 #include <dcmtk/dcmdata/dcdeftag.h>
 
+class DcmElement;
+class DcmWidgetElement;
+typedef std::pmr::vector<DcmWidgetElement> DcmElementList;
+
 class DcmWidgetElement
 {
 	public:
@@ -18,7 +24,7 @@ class DcmWidgetElement
 		QString getItemValue() const;
 		int getTableIndex() const;
 		int getDepth() const;
-		void calculateTableIndex(const int& current,const std::vector<DcmWidgetElement>& elements);
+		void calculateTableIndex(const int& current, const DcmElementList& elements);
 		std::string toString() const;
 		void setDepth(const int& depth);
 		void setTableIndex(const int& index);
@@ -29,11 +35,20 @@ class DcmWidgetElement
 		void calculateDepthFromTag();
 		void setVR(const QString& str);
 		void setValue(const  QString& str);
+		void setSource(DcmElement* element);
+		DcmElement* getSource() const;
+		void setLocation(qint64 offset, quint32 headerLength, qint64 valueLength);
+		qint64 getOffset() const;
+		quint32 getHeaderLength() const;
+		qint64 getValueLength() const;
+		bool hasLocation() const;
+		void setCorrupt(bool corrupt);
+		bool isCorrupt() const;
 		static int hexToDecimal(const char* hex);
-		bool operator==(DcmWidgetElement &element) const;
-		bool operator>(DcmWidgetElement &element) const;
-		bool operator<(DcmWidgetElement &element) const;
-		int compareTagKey(DcmWidgetElement &element) const;
+		bool operator==(const DcmWidgetElement &element) const;
+		bool operator>(const DcmWidgetElement &element) const;
+		bool operator<(const DcmWidgetElement &element) const;
+		int compareTagKey(const DcmWidgetElement &element) const;
 
 	private:
 		QString itemTag;
@@ -41,7 +56,13 @@ class DcmWidgetElement
 		QString itemVM;
 		QString itemLength;
 		QString itemDescription;
-		QString itemValue;
+		mutable QString itemValue;
+		DcmElement* source = nullptr;
+		mutable bool formatted = false;
+		qint64 offset = -1;
+		qint64 valueLength = 0;
+		quint32 headerLength = 0;
+		bool corrupt = false;
 		int depth = -1;
 		int tableIndex = -1;
 };
\ No newline at end of file
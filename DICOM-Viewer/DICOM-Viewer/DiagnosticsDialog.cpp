@@ -0,0 +1,79 @@
+#include "DiagnosticsDialog.h"
+#include <QtWidgets/qfiledialog.h>
+#include <QtWidgets/qmessagebox.h>
+#include "DcmProfiler.h"
+
+DiagnosticsDialog::DiagnosticsDialog(QWidget * parent) : QDialog(parent)
+{
+	ui.setupUi(this);
+	setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+	this->setAttribute(Qt::WA_DeleteOnClose, true);
+	ui.tablePhases->horizontalHeader()->setStretchLastSection(true);
+	ui.tablePhases->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	ui.tableCounters->horizontalHeader()->setStretchLastSection(true);
+	ui.tableCounters->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	ui.checkEnabled->setChecked(DcmProfiler::instance().isEnabled());
+	this->refreshPressed();
+}
+
+//========================================================================================================================
+void DiagnosticsDialog::refreshPressed()
+{
+	const auto summary = DcmProfiler::instance().getSummary();
+	const auto counters = DcmProfiler::instance().getCounters();
+	int row = 0;
+
+	ui.tablePhases->setRowCount(static_cast<int>(summary.size()));
+
+	for (const auto& phase : summary)
+	{
+		const double total = phase.second.total / 1000.0;
+		ui.tablePhases->setItem(row, 0, new QTableWidgetItem(QString::fromStdString(phase.first)));
+		ui.tablePhases->setItem(row, 1, new QTableWidgetItem(QString::number(phase.second.calls)));
+		ui.tablePhases->setItem(row, 2, new QTableWidgetItem(QString::number(total, 'f', 3)));
+		ui.tablePhases->setItem(row, 3, new QTableWidgetItem(QString::number(total / phase.second.calls, 'f', 3)));
+		ui.tablePhases->setItem(row, 4, new QTableWidgetItem(QString::number(phase.second.max / 1000.0, 'f', 3)));
+		row++;
+	}
+
+	row = 0;
+	ui.tableCounters->setRowCount(static_cast<int>(counters.size()));
+
+	for (const auto& counter : counters)
+	{
+		ui.tableCounters->setItem(row, 0, new QTableWidgetItem(QString::fromStdString(counter.first)));
+		ui.tableCounters->setItem(row, 1, new QTableWidgetItem(QString::number(counter.second)));
+		row++;
+	}
+
+	ui.tablePhases->resizeColumnsToContents();
+	ui.tableCounters->resizeColumnsToContents();
+}
+
+//========================================================================================================================
+void DiagnosticsDialog::clearPressed()
+{
+	DcmProfiler::instance().clear();
+	this->refreshPressed();
+}
+
+//========================================================================================================================
+void DiagnosticsDialog::exportPressed()
+{
+	const QString fileName = QFileDialog::getSaveFileName(this, tr("Export Trace"), tr(""), tr("Chrome Trace (*.json)"));
+
+	if (!fileName.isEmpty() && !DcmProfiler::instance().exportChromeTrace(QFile::encodeName(fileName).toStdString()))
+	{
+		auto* messageBox = new QMessageBox();
+		messageBox->setIcon(QMessageBox::Warning);
+		messageBox->setText("Failed to export trace!");
+		messageBox->exec();
+		delete messageBox;
+	}
+}
+
+//========================================================================================================================
+void DiagnosticsDialog::enabledToggled(const bool enabled)
+{
+	DcmProfiler::instance().setEnabled(enabled);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QObject>
+#include <qdialog.h>
+#include "ui_DiagnosticsDialog.h"
+
+class DiagnosticsDialog final : public QDialog
+{
+	Q_OBJECT
+
+	public:
+		explicit DiagnosticsDialog(QWidget* parent);
+		~DiagnosticsDialog() = default;
+
+	private:
+		Ui::diagnosticsDialog ui{};
+
+	private slots:
+		void refreshPressed();
+		void clearPressed();
+		void exportPressed();
+		void enabledToggled(bool enabled);
+};
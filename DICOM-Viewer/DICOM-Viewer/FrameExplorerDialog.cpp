@@ -0,0 +1,52 @@
+#include "FrameExplorerDialog.h"
+#include <QElapsedTimer>
+#include <QHeaderView>
+
+FrameExplorerDialog::FrameExplorerDialog(QWidget * parent, DcmDataset* dataset) : QDialog(parent)
+{
+	ui.setupUi(this);
+	setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+	setAttribute(Qt::WA_DeleteOnClose);
+	this->model = new DcmFrameModel(this);
+	ui.tableFrames->setModel(this->model);
+
+	QString error;
+	QElapsedTimer timer;
+	timer.start();
+	DcmFrameTable table;
+
+	if (!table.build(dataset, error))
+	{
+		ui.labelSummary->setText(error);
+		ui.spinPosition->setEnabled(false);
+		ui.buttonFind->setEnabled(false);
+		return;
+	}
+
+	const bool slicePosition = table.hasSlicePosition();
+	ui.labelSummary->setText(QString::number(table.getFrameCount()) + " frames, " + QString::number(table.getColumnCount()) + " attributes, read in "
+		+ QString::number(timer.elapsed()) + " ms");
+	this->model->setTable(std::move(table));
+	ui.tableFrames->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+	ui.tableFrames->setSortingEnabled(true);
+	ui.tableFrames->resizeColumnsToContents();
+	ui.spinPosition->setEnabled(slicePosition);
+	ui.buttonFind->setEnabled(slicePosition);
+}
+
+//========================================================================================================================
+void FrameExplorerDialog::findPosition()
+{
+	const int frame = this->model->getTable().findNearestFrame(ui.spinPosition->value());
+
+	if (frame < 0)
+	{
+		ui.labelFound->setText("No frame has a position");
+		return;
+	}
+
+	const int row = this->model->rowOfFrame(frame);
+	ui.tableFrames->selectRow(row);
+	ui.tableFrames->scrollTo(this->model->index(row, 0));
+	ui.labelFound->setText("Frame " + QString::number(frame + 1) + " at " + this->model->getTable().getColumn(0).text[frame]);
+}
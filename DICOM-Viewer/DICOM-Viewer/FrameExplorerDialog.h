@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QObject>
+#include <qdialog.h>
+#include "ui_FrameExplorerDialog.h"
+#include "DcmFrameModel.h"
+
+class FrameExplorerDialog final : public QDialog
+{
+	Q_OBJECT
+
+	public:
+		FrameExplorerDialog(QWidget* parent, DcmDataset* dataset);
+		~FrameExplorerDialog() = default;
+
+	private:
+		Ui::frameExplorerDialog ui{};
+		DcmFrameModel* model{};
+
+	private slots:
+		void findPosition();
+};
@@ -0,0 +1,125 @@
+#include "HexInspectorDialog.h"
+#include <algorithm>
+#include <QFontDatabase>
+
+#define BYTES_PER_LINE 16
+#define PAGE_SIZE 65536
+
+HexInspectorDialog::HexInspectorDialog(QWidget * parent, const QString& fileName, const qint64 offset, const qint64 length, const QString& title)
+	: QDialog(parent), file(fileName), offset(offset), length(length)
+{
+	ui.setupUi(this);
+	setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+	this->setAttribute(Qt::WA_DeleteOnClose, true);
+	this->setWindowTitle("Hex Inspector - " + title);
+	ui.textHex->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+	ui.spinPage->setMinimum(1);
+	ui.spinPage->setMaximum(static_cast<int>(std::max<qint64>(1, (length + PAGE_SIZE - 1) / PAGE_SIZE)));
+
+	if (this->file.open(QIODevice::ReadOnly))
+	{
+		this->showPage();
+	}
+}
+
+//========================================================================================================================
+HexInspectorDialog::~HexInspectorDialog()
+{
+	if (this->mapped)
+	{
+		this->file.unmap(this->mapped);
+	}
+}
+
+//========================================================================================================================
+bool HexInspectorDialog::isOpen() const
+{
+	return this->file.isOpen();
+}
+
+//========================================================================================================================
+void HexInspectorDialog::showPage()
+{
+	if (this->mapped)
+	{
+		this->file.unmap(this->mapped);
+		this->mapped = nullptr;
+	}
+
+	const qint64 start = this->page * PAGE_SIZE;
+	const qint64 count = std::min<qint64>(PAGE_SIZE, this->length - start);
+	QString text;
+
+	if (count > 0)
+	{
+		this->mapped = this->file.map(this->offset + start, count);
+	}
+
+	if (this->mapped)
+	{
+		text.reserve(static_cast<int>(count / BYTES_PER_LINE + 1) * 80);
+
+		for (qint64 i = 0; i < count; i += BYTES_PER_LINE)
+		{
+			text.append(formatLine(this->mapped + i, std::min<qint64>(BYTES_PER_LINE, count - i), this->offset + start + i));
+		}
+	}
+
+	const qint64 last = this->page * PAGE_SIZE + std::max<qint64>(count, 0);
+	ui.textHex->setPlainText(text);
+	ui.labelRange->setText("Bytes " + QString::number(this->offset + start) + " - " + QString::number(this->offset + last) + " of value at " +
+		QString::number(this->offset) + " (" + QString::number(this->length) + " bytes)");
+	ui.buttonPrevious->setEnabled(this->page > 0);
+	ui.buttonNext->setEnabled(last < this->length);
+	ui.spinPage->setValue(static_cast<int>(this->page + 1));
+}
+
+//========================================================================================================================
+QString HexInspectorDialog::formatLine(const uchar* data, const qint64 count, const qint64 offset)
+{
+	QString line = QString("%1  ").arg(offset, 12, 16, QChar('0')).toUpper();
+	QString ascii;
+
+	for (qint64 i = 0; i < BYTES_PER_LINE; i++)
+	{
+		if (i < count)
+		{
+			line.append(QString("%1 ").arg(static_cast<uint>(data[i]), 2, 16, QChar('0')).toUpper());
+			ascii.append(data[i] >= 0x20 && data[i] < 0x7F ? QChar(data[i]) : QChar('.'));
+		}
+
+		else
+		{
+			line.append("   ");
+		}
+	}
+
+	return line.append(' ').append(ascii).append('\n');
+}
+
+//========================================================================================================================
+void HexInspectorDialog::previousPressed()
+{
+	if (this->page > 0)
+	{
+		this->page--;
+		this->showPage();
+	}
+}
+
+//========================================================================================================================
+void HexInspectorDialog::nextPressed()
+{
+	if ((this->page + 1) * PAGE_SIZE < this->length)
+	{
+		this->page++;
+		this->showPage();
+	}
+}
+
+//========================================================================================================================
+void HexInspectorDialog::jumpPressed()
+{
+	this->page = ui.spinPage->value() - 1;
+	this->showPage();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QFile>
+#include <QObject>
+#include <qdialog.h>
+#include "ui_HexInspectorDialog.h"
+
+class HexInspectorDialog final : public QDialog
+{
+	Q_OBJECT
+
+	public:
+		HexInspectorDialog(QWidget* parent, const QString& fileName, qint64 offset, qint64 length, const QString& title);
+		~HexInspectorDialog();
+
+		bool isOpen() const;
+
+	private:
+		Ui::hexInspectorDialog ui{};
+		QFile file;
+		uchar* mapped = nullptr;
+		qint64 offset;
+		qint64 length;
+		qint64 page = 0;
+		void showPage();
+		static QString formatLine(const uchar* data, qint64 count, qint64 offset);
+
+	private slots:
+		void previousPressed();
+		void nextPressed();
+		void jumpPressed();
+};
@@ -0,0 +1,68 @@
+#include "ImageDiffDialog.h"
+#include <QElapsedTimer>
+#include <cmath>
+
+ImageDiffDialog::ImageDiffDialog(QWidget * parent, DcmFileFormat* first, DcmFileFormat* second) : QDialog(parent)
+{
+	ui.setupUi(this);
+	setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+	setAttribute(Qt::WA_DeleteOnClose);
+	QString error;
+	QElapsedTimer timer;
+	timer.start();
+
+	if (!this->diff.open(first, second, error))
+	{
+		ui.labelSummary->setText(error);
+		ui.spinFrame->setEnabled(false);
+		return;
+	}
+
+	this->frameStats.resize(this->diff.getFrameCount());
+
+	for (unsigned long frame = 0; frame < this->diff.getFrameCount(); frame++)
+	{
+		this->diff.compareFrame(frame, this->frameStats[frame]);
+		this->total.merge(this->frameStats[frame]);
+	}
+
+	unsigned long worst = 0;
+
+	for (unsigned long frame = 1; frame < this->frameStats.size(); frame++)
+	{
+		if (this->frameStats[frame].sumSquares > this->frameStats[worst].sumSquares)
+		{
+			worst = frame;
+		}
+	}
+
+	ui.labelSummary->setText(QString::number(this->diff.getWidth()) + " x " + QString::number(this->diff.getHeight()) + ", " + QString::number(this->diff.getFrameCount())
+		+ " frames compared in " + QString::number(timer.elapsed()) + " ms\n" + describe(this->total, this->diff.getPeak()) + "\nWorst frame: " + QString::number(worst + 1));
+	ui.spinFrame->setRange(1, OFstatic_cast(int, this->diff.getFrameCount()));
+	ui.spinFrame->setValue(OFstatic_cast(int, worst + 1));
+	this->frameChanged(ui.spinFrame->value());
+}
+
+//========================================================================================================================
+QString ImageDiffDialog::describe(const DcmImageDiff::Stats& stats, const double peak)
+{
+	const double psnr = stats.psnr(peak);
+
+	return "Max error: " + QString::number(stats.maxError) + ", mean error: " + QString::number(stats.meanError(), 'f', 4)
+		+ ", PSNR: " + (std::isinf(psnr) ? QString("identical") : QString::number(psnr, 'f', 2) + " dB")
+		+ ", differing samples: " + QString::number(stats.differing) + " of " + QString::number(stats.count);
+}
+
+//========================================================================================================================
+void ImageDiffDialog::frameChanged(const int frame)
+{
+	QImage image;
+
+	if (frame < 1 || OFstatic_cast(size_t, frame) > this->frameStats.size() || !this->diff.heatMap(frame - 1, image))
+	{
+		return;
+	}
+
+	ui.labelFrame->setText(describe(this->frameStats[frame - 1], this->diff.getPeak()));
+	ui.labelHeatMap->setPixmap(QPixmap::fromImage(image));
+}
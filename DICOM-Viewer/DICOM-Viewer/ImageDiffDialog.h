@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QObject>
+#include <qdialog.h>
+#include <vector>
+#include "ui_ImageDiffDialog.h"
+#include "DcmImageDiff.h"
+
+class ImageDiffDialog final : public QDialog
+{
+	Q_OBJECT
+
+	public:
+		ImageDiffDialog(QWidget* parent, DcmFileFormat* first, DcmFileFormat* second);
+		~ImageDiffDialog() = default;
+
+	private:
+		Ui::imageDiffDialog ui{};
+		DcmImageDiff diff;
+		std::vector<DcmImageDiff::Stats> frameStats;
+		DcmImageDiff::Stats total;
+		static QString describe(const DcmImageDiff::Stats& stats, double peak);
+
+	private slots:
+		void frameChanged(int frame);
+};
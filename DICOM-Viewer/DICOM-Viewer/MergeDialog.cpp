@@ -0,0 +1,167 @@
+#include "MergeDialog.h"
+#include <QRunnable>
+#include <QtWidgets/qfiledialog.h>
+#include <QtWidgets/qmessagebox.h>
+#include <functional>
+
+class DcmMergeTask final : public QRunnable
+{
+	public:
+		explicit DcmMergeTask(std::function<void()> work) : work(std::move(work)) { }
+
+		void run() override
+		{
+			this->work();
+		}
+
+	private:
+		std::function<void()> work;
+};
+
+MergeDialog::MergeDialog(QWidget * parent) : QDialog(parent)
+{
+	ui.setupUi(this);
+	setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+	this->setAttribute(Qt::WA_DeleteOnClose, true);
+	this->model = new DcmMergeModel(&this->engine, this);
+	ui.tableConflicts->setModel(this->model);
+	ui.tableConflicts->setItemDelegateForColumn(DcmMergeModel::UseColumn, new DcmMergeDelegate(this));
+	ui.tableConflicts->setEditTriggers(QAbstractItemView::AllEditTriggers);
+	ui.tableConflicts->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+	ui.tableConflicts->verticalHeader()->setDefaultSectionSize(20);
+	ui.tableConflicts->setColumnWidth(DcmMergeModel::PathColumn, ui.tableConflicts->columnWidth(DcmMergeModel::PathColumn) * 3);
+	ui.buttonSave->setEnabled(false);
+	this->pool.setMaxThreadCount(1);
+	connect(this, &MergeDialog::mergeFinished, this, &MergeDialog::mergeCompleted, Qt::QueuedConnection);
+}
+
+//========================================================================================================================
+MergeDialog::~MergeDialog()
+{
+	this->pool.waitForDone();
+}
+
+//========================================================================================================================
+void MergeDialog::alertFailed(const QString& message)
+{
+	auto* messageBox = new QMessageBox();
+	messageBox->setIcon(QMessageBox::Warning);
+	messageBox->setText(message);
+	messageBox->exec();
+	delete messageBox;
+}
+
+//========================================================================================================================
+void MergeDialog::browse(QLineEdit* line, const QString& title)
+{
+	const QString fileName = QFileDialog::getOpenFileName(this, title);
+
+	if (!fileName.isEmpty())
+	{
+		line->setText(fileName);
+	}
+}
+
+//========================================================================================================================
+void MergeDialog::browseBase()
+{
+	this->browse(ui.lineBase, tr("Original File"));
+}
+
+//========================================================================================================================
+void MergeDialog::browseOurs()
+{
+	this->browse(ui.lineOurs, tr("Our Version"));
+}
+
+//========================================================================================================================
+void MergeDialog::browseTheirs()
+{
+	this->browse(ui.lineTheirs, tr("Their Version"));
+}
+
+//========================================================================================================================
+void MergeDialog::setBusy(const bool busy) const
+{
+	ui.buttonMerge->setEnabled(!busy);
+	ui.buttonSave->setEnabled(!busy && this->merged);
+	ui.buttonBase->setEnabled(!busy);
+	ui.buttonOurs->setEnabled(!busy);
+	ui.buttonTheirs->setEnabled(!busy);
+}
+
+//========================================================================================================================
+void MergeDialog::mergePressed()
+{
+	if (ui.lineBase->text().isEmpty() || ui.lineOurs->text().isEmpty() || ui.lineTheirs->text().isEmpty())
+	{
+		alertFailed("Select the original file and both versions!");
+		return;
+	}
+
+	const QString base = ui.lineBase->text();
+	const QString ours = ui.lineOurs->text();
+	const QString theirs = ui.lineTheirs->text();
+
+	// the model lets go of the conflicts before the worker rebuilds them
+	this->merged = false;
+	this->model->refresh(false);
+	this->setBusy(true);
+	ui.labelStatus->setText("Merging...");
+
+	this->pool.start(new DcmMergeTask([this, base, ours, theirs]()
+	{
+		QString error;
+		const bool loaded = this->engine.load(base, ours, theirs, error);
+
+		if (loaded)
+		{
+			this->engine.merge();
+		}
+
+		emit mergeFinished(loaded, error);
+	}));
+}
+
+//========================================================================================================================
+void MergeDialog::mergeCompleted(const bool ok, const QString& error)
+{
+	if (!ok)
+	{
+		this->setBusy(false);
+		ui.labelStatus->clear();
+		alertFailed(error);
+		return;
+	}
+
+	this->merged = true;
+	this->setBusy(false);
+	this->model->refresh(true);
+	ui.labelStatus->setText(QString::number(this->engine.getApplied()) + " changes applied automatically, " + QString::number(this->engine.getConflicts().size()) + " conflicts");
+}
+
+//========================================================================================================================
+void MergeDialog::savePressed()
+{
+	if (!this->merged)
+	{
+		return;
+	}
+
+	const QString fileName = QFileDialog::getSaveFileName(this, tr("Save Merged File"), QString(), tr("DICOM File (*.dcm)"));
+
+	if (fileName.isEmpty())
+	{
+		return;
+	}
+
+	const OFCondition cond = this->engine.save(fileName);
+
+	if (cond.bad())
+	{
+		alertFailed(QString("Failed to save: ") + cond.text());
+		return;
+	}
+
+	ui.labelStatus->setText("Saved " + fileName);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <qdialog.h>
+#include "ui_MergeDialog.h"
+#include "DcmMergeModel.h"
+#include "DcmThreeWayMerge.h"
+
+class MergeDialog final : public QDialog
+{
+	Q_OBJECT
+
+	public:
+		explicit MergeDialog(QWidget* parent);
+		~MergeDialog();
+
+	signals:
+		void mergeFinished(bool ok, const QString& error);
+
+	private:
+		Ui::mergeDialog ui{};
+		DcmThreeWayMerge engine;
+		DcmMergeModel* model{};
+		QThreadPool pool;
+		bool merged = false;
+		static void alertFailed(const QString& message);
+		void browse(QLineEdit* line, const QString& title);
+		void setBusy(bool busy) const;
+
+	private slots:
+		void browseBase();
+		void browseOurs();
+		void browseTheirs();
+		void mergePressed();
+		void savePressed();
+		void mergeCompleted(bool ok, const QString& error);
+};
@@ -0,0 +1,247 @@
+#include "StatisticsDialog.h"
+#include <QDirIterator>
+#include <QFile>
+#include <QRunnable>
+#include <QThread>
+#include <QtWidgets/qfiledialog.h>
+#include <functional>
+#include "DcmStreamParser.h"
+#include "dcmtk/dcmdata/dctag.h"
+
+class DcmStatisticsTask final : public QRunnable
+{
+	public:
+		explicit DcmStatisticsTask(std::function<void()> work) : work(std::move(work)) { }
+
+		void run() override
+		{
+			this->work();
+		}
+
+	private:
+		std::function<void()> work;
+};
+
+class DcmStatisticsCounter final : public DcmStreamHandler
+{
+	public:
+		DcmStatisticsCounter(DcmDatasetStats& stats, const std::atomic<bool>& cancelled) : stats(stats), cancelled(cancelled) { }
+
+		bool onEvent(const DcmStreamEvent& event) override
+		{
+			if (event.kind == DcmStreamEvent::Kind::Element || event.kind == DcmStreamEvent::Kind::SequenceStart)
+			{
+				this->stats.add(event.tag, event.vr, event.kind == DcmStreamEvent::Kind::Element ? event.valueLength : 0, event.depth);
+			}
+
+			return !this->cancelled;
+		}
+
+	private:
+		DcmDatasetStats& stats;
+		const std::atomic<bool>& cancelled;
+};
+
+static QTableWidgetItem* numberItem(const Uint64 number)
+{
+	auto* item = new QTableWidgetItem();
+	item->setData(Qt::DisplayRole, QVariant::fromValue<qulonglong>(number));
+	item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+	return item;
+}
+
+static QString tagText(const DcmTagKey& tag)
+{
+	return QString("(%1,%2)").arg(tag.getGroup(), 4, 16, QChar('0')).arg(tag.getElement(), 4, 16, QChar('0')).toUpper();
+}
+
+StatisticsDialog::StatisticsDialog(QWidget * parent, const DcmDatasetStats& current) : QDialog(parent)
+{
+	ui.setupUi(this);
+	setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+	setAttribute(Qt::WA_DeleteOnClose);
+	ui.tableGroups->setHorizontalHeaderLabels({ "Group", "Elements", "Value Bytes" });
+	ui.tableVRs->setHorizontalHeaderLabels({ "VR", "Elements" });
+	ui.tableDepths->setHorizontalHeaderLabels({ "Nesting", "Elements" });
+	ui.tableLargest->setHorizontalHeaderLabels({ "Tag", "VR", "Length", "Nesting", "File" });
+	ui.progressBar->setVisible(false);
+	ui.buttonCancel->setEnabled(false);
+	connect(this, &StatisticsDialog::fileScanned, this, &StatisticsDialog::scanProgress, Qt::QueuedConnection);
+	this->display(current, "Current file");
+}
+
+//========================================================================================================================
+StatisticsDialog::~StatisticsDialog()
+{
+	this->cancelled = true;
+	this->pool.clear();
+	this->pool.waitForDone();
+}
+
+//========================================================================================================================
+void StatisticsDialog::display(const DcmDatasetStats& stats, const QString& title)
+{
+	const Uint64 elements = stats.getElementCount();
+	ui.labelSummary->setText(title + ": " + QString::number(elements) + " elements, " + QString::number(elements - stats.getPrivateCount()) + " public, "
+		+ QString::number(stats.getPrivateCount()) + " private, " + QString::number(stats.getTotalBytes()) + " value bytes"
+		+ (stats.getFileCount() ? ", " + QString::number(stats.getFileCount()) + " files" : QString()));
+
+	const auto& groups = stats.getGroups();
+	ui.tableGroups->setSortingEnabled(false);
+	ui.tableGroups->setRowCount(static_cast<int>(groups.size()));
+	int row = 0;
+
+	for (const auto& group : groups)
+	{
+		ui.tableGroups->setItem(row, 0, new QTableWidgetItem(QString("%1").arg(group.first, 4, 16, QChar('0')).toUpper()));
+		ui.tableGroups->setItem(row, 1, numberItem(group.second.elements));
+		ui.tableGroups->setItem(row, 2, numberItem(group.second.bytes));
+		row++;
+	}
+
+	ui.tableGroups->setSortingEnabled(true);
+
+	const auto& vrs = stats.getVRs();
+	ui.tableVRs->setSortingEnabled(false);
+	ui.tableVRs->setRowCount(static_cast<int>(vrs.size()));
+	row = 0;
+
+	for (const auto& vr : vrs)
+	{
+		ui.tableVRs->setItem(row, 0, new QTableWidgetItem(DcmVR(vr.first).getVRName()));
+		ui.tableVRs->setItem(row, 1, numberItem(vr.second));
+		row++;
+	}
+
+	ui.tableVRs->setSortingEnabled(true);
+
+	const auto& depths = stats.getDepths();
+	ui.tableDepths->setRowCount(static_cast<int>(depths.size()));
+
+	for (row = 0; row < static_cast<int>(depths.size()); row++)
+	{
+		ui.tableDepths->setItem(row, 0, numberItem(row));
+		ui.tableDepths->setItem(row, 1, numberItem(depths[row]));
+	}
+
+	const std::vector<DcmDatasetStats::Element> largest = stats.getLargest();
+	ui.tableLargest->setRowCount(static_cast<int>(largest.size()));
+
+	for (row = 0; row < static_cast<int>(largest.size()); row++)
+	{
+		const DcmDatasetStats::Element& element = largest[row];
+		ui.tableLargest->setItem(row, 0, new QTableWidgetItem(tagText(element.tag) + " " + DcmTag(element.tag).getTagName()));
+		ui.tableLargest->setItem(row, 1, new QTableWidgetItem(DcmVR(element.vr).getVRName()));
+		ui.tableLargest->setItem(row, 2, numberItem(element.length));
+		ui.tableLargest->setItem(row, 3, numberItem(element.depth));
+		ui.tableLargest->setItem(row, 4, new QTableWidgetItem(element.file));
+	}
+
+	for (QTableWidget* table : { ui.tableGroups, ui.tableVRs, ui.tableDepths, ui.tableLargest })
+	{
+		table->resizeColumnsToContents();
+	}
+}
+
+//========================================================================================================================
+void StatisticsDialog::scanFolder()
+{
+	if (this->scanning)
+	{
+		return;
+	}
+
+	const QString folder = QFileDialog::getExistingDirectory(this, tr("Folder to Analyze"));
+
+	if (folder.isEmpty())
+	{
+		return;
+	}
+
+	this->folderStats.clear();
+	this->cancelled = false;
+	this->scanned = 0;
+	this->total = 0;
+	this->scanning = true;
+	this->pool.setMaxThreadCount(QThread::idealThreadCount());
+	QDirIterator iterator(folder, QDir::Files, QDirIterator::Subdirectories);
+
+	while (iterator.hasNext())
+	{
+		const QString fileName = iterator.next();
+		this->pool.start(new DcmStatisticsTask([this, fileName] { this->scanFile(fileName); }));
+		this->total++;
+	}
+
+	ui.progressBar->setRange(0, this->total);
+	ui.progressBar->setValue(0);
+	ui.progressBar->setVisible(true);
+	ui.buttonCancel->setEnabled(true);
+	ui.buttonFolder->setEnabled(false);
+
+	if (this->total == 0)
+	{
+		this->finishScan();
+	}
+}
+
+//========================================================================================================================
+void StatisticsDialog::scanFile(const QString& fileName)
+{
+	if (this->cancelled)
+	{
+		return;
+	}
+
+	// every file is counted into its own totals, merging them is cheap next to parsing
+	DcmDatasetStats stats;
+	stats.setFile(fileName);
+	DcmStatisticsCounter counter(stats, this->cancelled);
+	DcmStreamParser parser;
+	parser.setPreviewLength(0);
+	parser.setTolerant(true);
+
+	if (parser.parseFile(QFile::encodeName(fileName).toStdString(), counter) || stats.getElementCount())
+	{
+		std::lock_guard<std::mutex> lock(this->statsMutex);
+		this->folderStats.merge(stats);
+	}
+
+	this->scanned++;
+	emit fileScanned();
+}
+
+//========================================================================================================================
+void StatisticsDialog::scanProgress()
+{
+	if (!this->scanning)
+	{
+		return;
+	}
+
+	ui.progressBar->setValue(this->scanned);
+
+	if (this->scanned == this->total)
+	{
+		this->finishScan();
+	}
+}
+
+//========================================================================================================================
+void StatisticsDialog::cancelPressed()
+{
+	this->cancelled = true;
+	this->pool.clear();
+	this->pool.waitForDone();
+	this->finishScan();
+}
+
+//========================================================================================================================
+void StatisticsDialog::finishScan()
+{
+	this->scanning = false;
+	ui.progressBar->setVisible(false);
+	ui.buttonCancel->setEnabled(false);
+	ui.buttonFolder->setEnabled(true);
+	this->display(this->folderStats, this->cancelled ? "Folder (cancelled)" : "Folder");
+}
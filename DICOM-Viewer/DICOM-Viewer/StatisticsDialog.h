@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <qdialog.h>
+#include <atomic>
+#include <mutex>
+#include "ui_StatisticsDialog.h"
+#include "DcmDatasetStats.h"
+
+class StatisticsDialog final : public QDialog
+{
+	Q_OBJECT
+
+	public:
+		StatisticsDialog(QWidget* parent, const DcmDatasetStats& current);
+		~StatisticsDialog();
+
+	signals:
+		void fileScanned();
+
+	private:
+		Ui::statisticsDialog ui{};
+		DcmDatasetStats folderStats;
+		std::mutex statsMutex;
+		QThreadPool pool;
+		std::atomic<bool> cancelled{ false };
+		std::atomic<int> scanned{ 0 };
+		int total = 0;
+		bool scanning = false;
+		void display(const DcmDatasetStats& stats, const QString& title);
+		void scanFile(const QString& fileName);
+		void finishScan();
+
+	private slots:
+		void scanFolder();
+		void scanProgress();
+		void cancelPressed();
+};
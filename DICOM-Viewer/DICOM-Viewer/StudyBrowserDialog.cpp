@@ -0,0 +1,281 @@
+#include "StudyBrowserDialog.h"
+#include <QtWidgets/qfiledialog.h>
+#include <QtWidgets/qmessagebox.h>
+#include <QFileInfo>
+#include <algorithm>
+#include <tuple>
+
+StudyBrowserDialog::StudyBrowserDialog(QWidget * parent) : QDialog(parent)
+{
+	ui.setupUi(this);
+	setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+	this->setAttribute(Qt::WA_DeleteOnClose, true);
+	ui.treeStudies->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+	connect(&index, &DcmStudyIndex::progress, this, &StudyBrowserDialog::indexProgress);
+	connect(&index, &DcmStudyIndex::finished, this, &StudyBrowserDialog::indexFinished);
+	connect(&index, &DcmStudyIndex::updated, this, &StudyBrowserDialog::indexUpdated);
+	connect(&watcher, &DcmFolderWatcher::filesChanged, this, &StudyBrowserDialog::filesChanged);
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::alertFailed(const QString& message)
+{
+	auto* messageBox = new QMessageBox();
+	messageBox->setIcon(QMessageBox::Warning);
+	messageBox->setText(message);
+	messageBox->exec();
+	delete messageBox;
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::browsePressed()
+{
+	const QString folder = QFileDialog::getExistingDirectory(this, tr("Study Folder"));
+
+	if (!folder.isEmpty())
+	{
+		ui.lineFolder->setText(folder);
+		this->loadPressed();
+	}
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::loadPressed()
+{
+	if (ui.lineFolder->text().isEmpty() || !QDir(ui.lineFolder->text()).exists())
+	{
+		alertFailed("Select an existing folder!");
+		return;
+	}
+
+	if (this->index.isRunning())
+	{
+		return;
+	}
+
+	ui.checkWatch->setChecked(false);
+
+	// a persisted index or a DICOMDIR opens instantly, then only files changed since it was written are parsed
+	if (this->index.load(ui.lineFolder->text()))
+	{
+		this->populate();
+		ui.labelStatus->setText(QString::number(this->index.getRecords().size()) + " instances from index");
+		this->index.refresh();
+		return;
+	}
+
+	this->rescanPressed();
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::rescanPressed()
+{
+	if (ui.lineFolder->text().isEmpty() || this->index.isRunning())
+	{
+		return;
+	}
+
+	ui.treeStudies->clear();
+	this->nodes.clear();
+	ui.buttonLoad->setEnabled(false);
+	ui.buttonRescan->setEnabled(false);
+	ui.progressBar->setValue(0);
+	ui.labelStatus->setText("Scanning...");
+	this->index.start(ui.lineFolder->text(), 0);
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::indexProgress(const int done, const int total)
+{
+	ui.progressBar->setMaximum(total);
+	ui.progressBar->setValue(done);
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::indexFinished()
+{
+	ui.buttonLoad->setEnabled(true);
+	ui.buttonRescan->setEnabled(true);
+
+	if (!this->index.save())
+	{
+		alertFailed("Failed to save the folder index!");
+	}
+
+	this->populate();
+	ui.labelStatus->setText(QString::number(this->index.getRecords().size()) + " instances indexed");
+	this->updatePending();
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::indexUpdated(const QStringList& changed, const QStringList& removed)
+{
+	ui.treeStudies->setUpdatesEnabled(false);
+
+	for (const auto& fileName : removed)
+	{
+		this->removeInstance(fileName);
+	}
+
+	for (const auto& fileName : changed)
+	{
+		DcmStudyIndex::Record record;
+		this->removeInstance(fileName);
+
+		if (this->index.getRecord(fileName, record))
+		{
+			this->addInstance(record);
+		}
+	}
+
+	ui.treeStudies->setUpdatesEnabled(true);
+
+	if (!changed.empty() || !removed.empty())
+	{
+		this->index.save();
+		ui.labelStatus->setText(QString::number(changed.size()) + " updated, " + QString::number(removed.size()) + " removed");
+	}
+
+	this->updatePending();
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::watchToggled(const bool checked)
+{
+	if (!checked)
+	{
+		this->watcher.stop();
+		return;
+	}
+
+	if (this->index.getFolder().isEmpty())
+	{
+		ui.checkWatch->setChecked(false);
+		alertFailed("Open a folder first!");
+		return;
+	}
+
+	this->watcher.watch(this->index.getFolder());
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::filesChanged(const QStringList& files)
+{
+	this->pending.append(files);
+	this->updatePending();
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::updatePending()
+{
+	// the index handles one batch at a time, changes arriving meanwhile wait for the next one
+	if (this->pending.empty() || this->index.isRunning())
+	{
+		return;
+	}
+
+	const QStringList files = this->pending;
+	this->pending.clear();
+	this->index.update(files);
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::populate()
+{
+	std::vector<DcmStudyIndex::Record> records = this->index.getRecords();
+
+	std::sort(records.begin(), records.end(), [](const DcmStudyIndex::Record& first, const DcmStudyIndex::Record& second)
+	{
+		return std::tie(first.patientName, first.patientId, first.studyDate, first.studyUid, first.seriesNumber, first.seriesUid, first.instanceNumber, first.fileName)
+			< std::tie(second.patientName, second.patientId, second.studyDate, second.studyUid, second.seriesNumber, second.seriesUid, second.instanceNumber, second.fileName);
+	});
+
+	ui.treeStudies->setUpdatesEnabled(false);
+	ui.treeStudies->clear();
+	this->nodes.clear();
+
+	for (const auto& record : records)
+	{
+		this->addInstance(record);
+	}
+
+	ui.treeStudies->setUpdatesEnabled(true);
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::addInstance(const DcmStudyIndex::Record& record)
+{
+	const QString patientKey = "P:" + record.patientId + "\t" + record.patientName;
+	const QString studyKey = "S:" + record.studyUid;
+	const QString seriesKey = "R:" + record.seriesUid;
+	QTreeWidgetItem* patient = this->nodes.value(patientKey);
+	QTreeWidgetItem* study = this->nodes.value(studyKey);
+	QTreeWidgetItem* series = this->nodes.value(seriesKey);
+
+	if (!patient)
+	{
+		patient = new QTreeWidgetItem(ui.treeStudies, QStringList{ QString(record.patientName).replace('^', ' '), record.patientId, record.patientBirthDate });
+		patient->setData(0, Qt::UserRole + 1, patientKey);
+		this->nodes.insert(patientKey, patient);
+	}
+
+	if (!study)
+	{
+		study = new QTreeWidgetItem(patient, QStringList{ record.studyDescription.isEmpty() ? record.studyUid : record.studyDescription, record.accessionNumber, record.studyDate });
+		study->setData(0, Qt::UserRole + 1, studyKey);
+		this->nodes.insert(studyKey, study);
+	}
+
+	if (!series)
+	{
+		series = new QTreeWidgetItem(study, QStringList{ record.modality + " " + record.seriesDescription, "Series " + QString::number(record.seriesNumber), QString() });
+		series->setData(0, Qt::UserRole + 1, seriesKey);
+		this->nodes.insert(seriesKey, series);
+	}
+
+	auto* instance = new QTreeWidgetItem(series, QStringList{ QFileInfo(record.fileName).fileName(), "Instance " + QString::number(record.instanceNumber), record.sopInstanceUid });
+	instance->setData(0, Qt::UserRole, record.fileName);
+	instance->setData(0, Qt::UserRole + 1, "I:" + record.fileName);
+	this->nodes.insert("I:" + record.fileName, instance);
+	series->setText(2, QString::number(series->childCount()) + " instances");
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::removeInstance(const QString& fileName)
+{
+	QTreeWidgetItem* item = this->nodes.value("I:" + fileName);
+
+	// drop the instance, then every ancestor it leaves empty
+	while (item)
+	{
+		QTreeWidgetItem* parent = item->parent();
+		this->nodes.remove(item->data(0, Qt::UserRole + 1).toString());
+		delete item;
+
+		if (parent && parent->childCount() && parent->data(0, Qt::UserRole + 1).toString().startsWith("R:"))
+		{
+			parent->setText(2, QString::number(parent->childCount()) + " instances");
+		}
+
+		item = parent && !parent->childCount() ? parent : nullptr;
+	}
+}
+
+//========================================================================================================================
+void StudyBrowserDialog::itemActivated(QTreeWidgetItem* item, int column)
+{
+	const QString fileName = item->data(0, Qt::UserRole).toString();
+
+	if (fileName.isEmpty())
+	{
+		return;
+	}
+
+	if (!QFileInfo::exists(fileName))
+	{
+		alertFailed("File no longer exists, rescan the folder!");
+		return;
+	}
+
+	emit instanceSelected(fileName);
+}
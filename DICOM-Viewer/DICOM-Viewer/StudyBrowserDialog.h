@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QObject>
+#include <qdialog.h>
+#include "ui_StudyBrowserDialog.h"
+#include "DcmStudyIndex.h"
+#include "DcmFolderWatcher.h"
+
+class StudyBrowserDialog final : public QDialog
+{
+	Q_OBJECT
+
+	public:
+		explicit StudyBrowserDialog(QWidget* parent);
+		~StudyBrowserDialog() = default;
+
+	signals:
+		void instanceSelected(const QString& fileName);
+
+	private:
+		Ui::studyBrowserDialog ui{};
+		DcmStudyIndex index;
+		DcmFolderWatcher watcher;
+		QStringList pending;
+		QHash<QString, QTreeWidgetItem*> nodes;
+		void populate();
+		void addInstance(const DcmStudyIndex::Record& record);
+		void removeInstance(const QString& fileName);
+		void updatePending();
+		static void alertFailed(const QString& message);
+
+	private slots:
+		void browsePressed();
+		void loadPressed();
+		void rescanPressed();
+		void itemActivated(QTreeWidgetItem* item, int column);
+		void indexProgress(int done, int total);
+		void indexFinished();
+		void indexUpdated(const QStringList& changed, const QStringList& removed);
+		void watchToggled(bool checked);
+		void filesChanged(const QStringList& files);
+};
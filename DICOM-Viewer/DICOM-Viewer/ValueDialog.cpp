@@ -0,0 +1,56 @@
+#include "ValueDialog.h"
+#include <algorithm>
+#include "DcmCsaHeader.h"
+#include "DcmValueFormatter.h"
+
+#define PAGE_SIZE 1000
+
+ValueDialog::ValueDialog(QWidget * parent, DcmElement* element, const QString& title) : QDialog(parent), element(element)
+{
+	ui.setupUi(this);
+	setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+	this->setWindowTitle(title);
+
+	// vendor blobs are decoded only when their row is opened, never while the table is built
+	if (DcmCsaHeader::isHeader(element))
+	{
+		DcmCsaHeader header;
+
+		if (header.parse(element))
+		{
+			this->decoded = header.format();
+		}
+	}
+
+	this->total = this->decoded.isEmpty() ? DcmValueFormatter::valueCount(element) : OFstatic_cast(unsigned long, this->decoded.size());
+	this->showPage();
+}
+
+//========================================================================================================================
+void ValueDialog::showPage()
+{
+	const unsigned long last = std::min(this->first + PAGE_SIZE, this->total);
+
+	ui.textValue->setPlainText(this->decoded.isEmpty() ? DcmValueFormatter::page(this->element, this->first, PAGE_SIZE)
+		: QStringList(this->decoded.mid(static_cast<int>(this->first), PAGE_SIZE)).join('\n'));
+	ui.labelRange->setText((this->decoded.isEmpty() ? "Values " : "CSA entries ") + QString::number(this->total ? this->first + 1 : 0) + " - " + QString::number(last) + " of " + QString::number(this->total));
+	ui.buttonPrevious->setEnabled(this->first > 0);
+	ui.buttonNext->setEnabled(last < this->total);
+}
+
+//========================================================================================================================
+void ValueDialog::previousPressed()
+{
+	this->first = this->first > PAGE_SIZE ? this->first - PAGE_SIZE : 0;
+	this->showPage();
+}
+
+//========================================================================================================================
+void ValueDialog::nextPressed()
+{
+	if (this->first + PAGE_SIZE < this->total)
+	{
+		this->first += PAGE_SIZE;
+		this->showPage();
+	}
+}
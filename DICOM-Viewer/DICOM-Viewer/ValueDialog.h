@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QObject>
+#include <qdialog.h>
+#include "ui_ValueDialog.h"
+#include "dcmtk/dcmdata/dcelem.h"
+
+class ValueDialog final : public QDialog
+{
+	Q_OBJECT
+
+	public:
+		ValueDialog(QWidget* parent, DcmElement* element, const QString& title);
+		~ValueDialog() = default;
+
+	private:
+		Ui::valueDialog ui{};
+		DcmElement* element;
+		unsigned long total = 0;
+		unsigned long first = 0;
+		QStringList decoded;
+		void showPage();
+
+	private slots:
+		void previousPressed();
+		void nextPressed();
+};
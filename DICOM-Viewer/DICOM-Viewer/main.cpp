@@ -1,10 +1,29 @@
 #include "DICOMViewer.h"
+#include "DcmBenchmark.h"
+#include "DcmCompareReport.h"
+#include "DcmTriage.h"
 #include <QtWidgets/QApplication>
 
 int main(int argc, char *argv[])
 {
 	QApplication a(argc, argv);
 	a.setWindowIcon(QIcon("./rsc/pxd_app_icon.png"));
+
+	if (DcmBenchmark::isRequested(a.arguments()))
+	{
+		return DcmBenchmark::run(a.arguments());
+	}
+
+	if (DcmTriage::isRequested(a.arguments()))
+	{
+		return DcmTriage::run(a.arguments());
+	}
+
+	if (DcmCompareReport::isRequested(a.arguments()))
+	{
+		return DcmCompareReport::run(a.arguments());
+	}
+
 	DICOMViewer w;
 	w.show();
 	return a.exec();